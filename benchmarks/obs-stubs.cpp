@@ -0,0 +1,19 @@
+#include <util/base.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+
+// 基准测试不加载 libobs 和 obs-frontend，插件界面代码用到的日志和性能分析函数在这里替换为空实现
+extern "C" {
+
+void blog(int, const char *, ...) {}
+
+void profile_register_root(const char *, uint64_t) {}
+void profile_start(const char *) {}
+void profile_end(const char *) {}
+
+uint64_t os_get_proc_resident_size(void)
+{
+    return 0;
+}
+
+}
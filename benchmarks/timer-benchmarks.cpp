@@ -0,0 +1,352 @@
+#include <benchmark/benchmark.h>
+#include <QApplication>
+#include <QDir>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "timer-dock.hpp"
+#include "export-format.hpp"
+#include "session-analytics.hpp"
+#include "tick-scheduler.hpp"
+#include "timer-service.hpp"
+
+// 直接调用 TimerDock 的私有槽，与按钮触发的路径相同
+class TimerDockBenchmark {
+public:
+    // records 条记录，每条一个时段；running 为 true 时全部开始计时，否则全部已结束
+    TimerDockBenchmark(int records, bool running)
+    {
+        dock.resize(600, 800);
+        // 第一次显示时创建界面和计时线程，并自带一条记录
+        dock.show();
+        QCoreApplication::processEvents();
+        for (int i = 1; i < records; ++i) {
+            dock.onAddRecord();
+        }
+
+        ClickStamper::Stamp stamp{dock.service->nowNs(), 0};
+        for (const auto &segment : unstartedSegments()) {
+            dock.onStartSegment(segment.first, segment.second, stamp);
+            if (!running) {
+                dock.onEndSegment(segment.first, segment.second, stamp);
+            }
+        }
+        QCoreApplication::processEvents();
+    }
+
+    void updateAllTimes() { dock.updateAllTimes(); }
+
+    void addAndDeleteRecord()
+    {
+        dock.onAddRecord();
+        dock.onDeleteRecord(dock.service->call([](TimerEngine &e) { return e.lastRecord(); }));
+    }
+
+    // 新添加的记录立即开始计时并刷新：对刚排列出来的行发出 dataChanged
+    void addAndStartRecord()
+    {
+        dock.onAddRecord();
+        QCoreApplication::processEvents();
+        ClickStamper::Stamp stamp{dock.service->nowNs(), 0};
+        for (const auto &segment : unstartedSegments()) {
+            dock.onStartSegment(segment.first, segment.second, stamp);
+        }
+        dock.updateAllTimes();
+        QCoreApplication::processEvents();
+    }
+
+    void addAndDeleteSegment()
+    {
+        RecordId recordId = dock.service->call([](TimerEngine &e) { return e.lastRecord(); });
+        dock.onAddSegment(recordId);
+        SegmentId segmentId =
+            dock.service->call([recordId](TimerEngine &e) { return e.findRecord(recordId)->segments.back(); });
+        dock.onDeleteSegment(recordId, segmentId);
+    }
+
+private:
+    std::vector<std::pair<RecordId, SegmentId>> unstartedSegments()
+    {
+        return dock.service->call([](TimerEngine &e) {
+            std::vector<std::pair<RecordId, SegmentId>> result;
+            for (RecordId id = e.firstRecord(); id != NO_ID; id = e.nextRecord(id)) {
+                for (SegmentId segmentId : e.findRecord(id)->segments) {
+                    if (!e.findSegment(segmentId)->isStarted()) {
+                        result.emplace_back(id, segmentId);
+                    }
+                }
+            }
+            return result;
+        });
+    }
+
+    TimerDock dock;
+};
+
+// 每次刷新的耗时，所有记录都在计时
+static void BM_UpdateAllTimes(benchmark::State &state)
+{
+    TimerDockBenchmark bench(static_cast<int>(state.range(0)), true);
+    for (auto _ : state) {
+        bench.updateAllTimes();
+    }
+    state.counters["records"] = static_cast<double>(state.range(0));
+}
+BENCHMARK(BM_UpdateAllTimes)->Arg(10)->Arg(100)->Arg(1000)->Arg(5000)->Unit(benchmark::kMicrosecond);
+
+static void BM_RecordChurn(benchmark::State &state)
+{
+    TimerDockBenchmark bench(static_cast<int>(state.range(0)), false);
+    for (auto _ : state) {
+        bench.addAndDeleteRecord();
+    }
+}
+BENCHMARK(BM_RecordChurn)->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+static void BM_SegmentChurn(benchmark::State &state)
+{
+    TimerDockBenchmark bench(static_cast<int>(state.range(0)), false);
+    for (auto _ : state) {
+        bench.addAndDeleteSegment();
+    }
+}
+BENCHMARK(BM_SegmentChurn)->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+// 导出用的模型：1,000 条记录，每条 100 个已结束的时段，共 100k 个时段
+struct ExportFixture {
+    TimerEngine engine;
+    int64_t nowNs;
+
+    ExportFixture()
+    {
+        nowNs = timerNowNs();
+        for (int r = 0; r < 1000; ++r) {
+            RecordId id = engine.addRecord(r % 2 ? SpeakerType::Discussant : SpeakerType::Speaker);
+            engine.setRecordName(id, "讲者" + std::to_string(r));
+            for (int s = 0; s < 100; ++s) {
+                SegmentId segmentId = NO_ID;
+                engine.addSegment(id, &segmentId);
+                engine.startSegment(segmentId, nowNs);
+                nowNs += 30 * NS_PER_SEC;
+                engine.endSegment(segmentId, nowNs);
+                nowNs += NS_PER_SEC;
+            }
+        }
+    }
+};
+
+static const ExportFixture &exportFixture()
+{
+    static const ExportFixture fixture;
+    return fixture;
+}
+
+static void BM_FormatTextExport(benchmark::State &state)
+{
+    const ExportFixture &fixture = exportFixture();
+    for (auto _ : state) {
+        QString text = formatTextExport(fixture.engine, fixture.nowNs);
+        benchmark::DoNotOptimize(text.constData());
+    }
+    state.SetItemsProcessed(state.iterations() * 100000);
+}
+BENCHMARK(BM_FormatTextExport)->Unit(benchmark::kMillisecond);
+
+static void BM_FormatCsvExport(benchmark::State &state)
+{
+    const ExportFixture &fixture = exportFixture();
+    for (auto _ : state) {
+        QString csv = formatCsvExport(fixture.engine, fixture.nowNs);
+        benchmark::DoNotOptimize(csv.constData());
+    }
+    state.SetItemsProcessed(state.iterations() * 100000);
+}
+BENCHMARK(BM_FormatCsvExport)->Unit(benchmark::kMillisecond);
+
+// 压缩后的字节直接丢弃，只统计大小
+static void BM_FormatXlsxExport(benchmark::State &state)
+{
+    const ExportFixture &fixture = exportFixture();
+    size_t bytes = 0;
+    for (auto _ : state) {
+        bytes = 0;
+        bool ok = writeXlsxExport(fixture.engine, fixture.nowNs, [&bytes](const char *, size_t size) {
+            bytes += size;
+            return true;
+        });
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations() * 100000);
+    state.counters["bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_FormatXlsxExport)->Unit(benchmark::kMillisecond);
+
+// 历史统计用的归档：20,000 场会话，每场 20 条记录、每条 3 个时段，姓名取自 500 位讲者
+struct ArchiveFixture {
+    QTemporaryDir directory;
+    SessionArchive archive;
+
+    ArchiveFixture()
+        : archive(QDir(directory.path()).filePath("archive").toStdString())
+    {
+        for (int session = 0; session < 20000; ++session) {
+            // 每场会话相隔一小时，归档文件名不重复
+            TimerEngine engine;
+            int64_t nowNs = session * 60 * NS_PER_MIN;
+            for (int r = 0; r < 20; ++r) {
+                RecordId id = engine.addRecord(r % 4 ? SpeakerType::Speaker : SpeakerType::Discussant);
+                engine.setRecordName(id, "讲者" + std::to_string((session * 7 + r) % 500));
+                for (int s = 0; s < 3; ++s) {
+                    SegmentId segmentId = NO_ID;
+                    engine.addSegment(id, &segmentId);
+                    engine.startSegment(segmentId, nowNs);
+                    nowNs += (60 + (session + r + s) % 120) * NS_PER_SEC;
+                    engine.endSegment(segmentId, nowNs);
+                }
+            }
+            archive.add(engine, nowNs);
+        }
+    }
+};
+
+static ArchiveFixture &archiveFixture()
+{
+    static ArchiveFixture fixture;
+    return fixture;
+}
+
+// 映射整个归档目录
+static void BM_LoadArchive(benchmark::State &state)
+{
+    ArchiveFixture &fixture = archiveFixture();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.archive.load());
+    }
+    state.SetItemsProcessed(state.iterations() * 20000);
+}
+BENCHMARK(BM_LoadArchive)->Unit(benchmark::kMillisecond);
+
+// 参数为线程数，0 表示 CPU 核数
+static void BM_AnalyzeSessions(benchmark::State &state)
+{
+    ArchiveFixture &fixture = archiveFixture();
+    fixture.archive.load();
+    for (auto _ : state) {
+        SessionAnalytics analytics = analyzeSessions(fixture.archive.sessions(), static_cast<int>(state.range(0)));
+        benchmark::DoNotOptimize(analytics.speakers.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 20000);
+}
+BENCHMARK(BM_AnalyzeSessions)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
+
+// 用暂停的虚拟时钟回放一整天的议程：96 位讲者每人 5 分钟，时钟直接推进，不等待真实时间
+static void BM_ReplayAgenda(benchmark::State &state)
+{
+    for (auto _ : state) {
+        VirtualClock clock(0.0);
+        TimerService service(clock);
+        for (int speaker = 0; speaker < 96; ++speaker) {
+            SegmentId segmentId = NO_ID;
+            service.call([&segmentId](TimerEngine &e) { e.addSegment(e.addRecord(SpeakerType::Speaker), &segmentId); });
+            service.startSegment(segmentId, clock.nowNs(), 0);
+            for (int minute = 0; minute < 5; ++minute) {
+                clock.advance(NS_PER_MIN);
+                service.clockChanged();
+            }
+            service.endSegment(segmentId, clock.nowNs(), 0);
+        }
+    }
+}
+BENCHMARK(BM_ReplayAgenda)->Unit(benchmark::kMillisecond);
+
+// 回归检查：很多记录同时计时、各自的整秒边界互不相同时，按 TickScheduler 的规则模拟十秒的刷新，
+// 每秒的刷新次数不超过 1000 / MIN_INTERVAL_MS，每个边界最多晚 COALESCE_MS 显示
+static bool checkTickCoalescing(int count)
+{
+    std::mt19937 random(static_cast<unsigned>(count));
+    std::uniform_int_distribution<int64_t> phase(0, 10 * NS_PER_SEC);
+    std::uniform_int_distribution<int64_t> closed(0, 100 * NS_PER_SEC);
+    std::vector<RunningTime> running(count);
+    for (RunningTime &entry : running) {
+        entry.startNs = phase(random);
+        entry.closedNs = closed(random);
+    }
+
+    const int64_t beginNs = 20 * NS_PER_SEC;
+    const int64_t endNs = 30 * NS_PER_SEC;
+    std::vector<int64_t> ticks;
+    for (int64_t nowNs = beginNs; nowNs < endNs;) {
+        int64_t tickNs = TickScheduler::nextTickNs(running, nowNs);
+        if (!ticks.empty()) {
+            tickNs = std::max(tickNs, ticks.back() + TickScheduler::MIN_INTERVAL_MS * NS_PER_MS);
+        }
+        ticks.push_back(tickNs);
+        nowNs = tickNs;
+    }
+    if (ticks.size() > static_cast<size_t>(10 * 1000 / TickScheduler::MIN_INTERVAL_MS + 1)) {
+        return false;
+    }
+    for (const RunningTime &entry : running) {
+        for (int64_t originNs : {entry.startNs, entry.startNs - entry.closedNs}) {
+            int64_t boundaryNs = originNs + ((beginNs - originNs) / NS_PER_SEC + 1) * NS_PER_SEC;
+            for (; boundaryNs < endNs - NS_PER_SEC; boundaryNs += NS_PER_SEC) {
+                auto tick = std::lower_bound(ticks.begin(), ticks.end(), boundaryNs);
+                if (tick == ticks.end() || *tick - boundaryNs > TickScheduler::COALESCE_MS * NS_PER_MS) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// 计划下一次刷新的耗时，每次刷新和每次开始、停止都要计划一次
+static void BM_PlanTick(benchmark::State &state)
+{
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int64_t> phase(0, 10 * NS_PER_SEC);
+    std::vector<RunningTime> running(state.range(0));
+    for (RunningTime &entry : running) {
+        entry.startNs = phase(random);
+        entry.closedNs = phase(random);
+    }
+    int64_t nowNs = 20 * NS_PER_SEC;
+    for (auto _ : state) {
+        nowNs = TickScheduler::nextTickNs(running, nowNs) + TickScheduler::MIN_INTERVAL_MS * NS_PER_MS;
+        benchmark::DoNotOptimize(nowNs);
+    }
+}
+BENCHMARK(BM_PlanTick)->Arg(1)->Arg(64)->Arg(1024);
+
+int main(int argc, char **argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    // 没有显示器的机器上也能运行
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    // 回归检查：新排列的行也必须有控件，否则这里在绑定时解引用空指针
+    {
+        TimerDockBenchmark bench(1, false);
+        bench.addAndStartRecord();
+    }
+    for (int count : {1, 3, 64, 1024}) {
+        if (!checkTickCoalescing(count)) {
+            std::fprintf(stderr, "tick coalescing check failed with %d running records\n", count);
+            return 1;
+        }
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
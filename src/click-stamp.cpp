@@ -0,0 +1,106 @@
+#include "click-stamp.hpp"
+#include <QAbstractButton>
+#include <QInputEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+
+// 超出这个范围的事件时间戳视为不可信（时间戳回绕、合成事件等），按接收时刻计
+static const int64_t MAX_PLAUSIBLE_DELAY_NS = 5 * NS_PER_SEC;
+
+// 点击信号在释放事件的处理中同步发出，超过这个时间的记录已过期
+static const int64_t PENDING_EXPIRE_NS = 100 * NS_PER_MS;
+
+ClickStamper::ClickStamper(const TimerClock &clock, QObject *parent)
+    : QObject(parent),
+      clock(clock),
+      offsetCount(0),
+      offsetNext(0)
+{
+}
+
+void ClickStamper::watch(QAbstractButton *button)
+{
+    button->installEventFilter(this);
+    connect(button, &QObject::destroyed, this, [this](QObject *object) { pending.remove(object); });
+}
+
+bool ClickStamper::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::HoverEnter:
+    case QEvent::HoverMove:
+        break;
+    default:
+        return false;
+    }
+
+    auto *input = static_cast<QInputEvent *>(event);
+    int64_t receivedNs = timerNowNs();
+    if (input->timestamp() == 0) {
+        return false;
+    }
+
+    int64_t eventMsNs = static_cast<int64_t>(input->timestamp()) * NS_PER_MS;
+    addOffsetSample(receivedNs - eventMsNs);
+
+    // 鼠标左键释放或空格键释放会触发按钮的 clicked
+    bool isClick = false;
+    if (event->type() == QEvent::MouseButtonRelease) {
+        isClick = static_cast<QMouseEvent *>(event)->button() == Qt::LeftButton;
+    } else if (event->type() == QEvent::KeyRelease) {
+        auto *keyEvent = static_cast<QKeyEvent *>(event);
+        isClick = !keyEvent->isAutoRepeat() &&
+                  (keyEvent->key() == Qt::Key_Space || keyEvent->key() == Qt::Key_Select);
+    }
+
+    if (isClick) {
+        int64_t eventNs = eventMsNs + offsetEstimate();
+        int64_t delayNs = receivedNs - eventNs;
+        if (delayNs < 0 || delayNs > MAX_PLAUSIBLE_DELAY_NS) {
+            eventNs = receivedNs;
+        }
+        pending.insert(watched, PendingClick{eventNs, receivedNs});
+    }
+    return false;
+}
+
+ClickStamper::Stamp ClickStamper::take(QObject *button)
+{
+    // 事件时间戳和过期判断都在单调时钟上进行，最后换算为计时所用时钟的读数
+    int64_t nowNs = timerNowNs();
+    auto it = pending.find(button);
+    if (it == pending.end()) {
+        return Stamp{clock.fromSteadyNs(nowNs), 0};
+    }
+
+    PendingClick click = *it;
+    pending.erase(it);
+    if (nowNs - click.receivedNs > PENDING_EXPIRE_NS) {
+        return Stamp{clock.fromSteadyNs(nowNs), 0};
+    }
+    return Stamp{clock.fromSteadyNs(click.eventNs), nowNs - click.eventNs};
+}
+
+void ClickStamper::addOffsetSample(int64_t offsetNs)
+{
+    offsets[offsetNext] = offsetNs;
+    offsetNext = (offsetNext + 1) % OFFSET_WINDOW;
+    if (offsetCount < OFFSET_WINDOW) {
+        ++offsetCount;
+    }
+}
+
+int64_t ClickStamper::offsetEstimate() const
+{
+    int64_t best = offsets[0];
+    for (int i = 1; i < offsetCount; ++i) {
+        if (offsets[i] < best) {
+            best = offsets[i];
+        }
+    }
+    return best;
+}
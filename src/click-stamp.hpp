@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include "timer-clock.hpp"
+
+class QAbstractButton;
+
+// 按钮点击时间戳：取自输入事件本身的时间，而不是槽函数执行的时间。
+// UI 线程繁忙时事件会在队列里排队，槽函数执行时读时钟会晚几百毫秒；
+// 输入事件的时间戳由系统在用户操作时打上，不受排队影响。
+//
+// 事件时间戳的起点由平台决定，这里用观察到的"接收时刻 - 事件时间"的
+// 最近若干个样本的最小值估计两个时钟之间的偏移（排队最短的样本最接近真实偏移）。
+class ClickStamper : public QObject {
+    Q_OBJECT
+
+public:
+    struct Stamp {
+        int64_t eventNs;    // 用户操作的时刻（计时所用时钟的读数）
+        int64_t latencyNs;  // 从用户操作到当前（提交）时刻的延迟
+    };
+
+    // 时间戳换算为 clock 的读数，与计时线程使用同一个时钟
+    explicit ClickStamper(const TimerClock &clock, QObject *parent = nullptr);
+
+    void watch(QAbstractButton *button);
+
+    // 取出按钮这次点击的时间；程序触发等没有输入事件的点击按当前时间计
+    Stamp take(QObject *button);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct PendingClick {
+        int64_t eventNs;
+        int64_t receivedNs;
+    };
+
+    void addOffsetSample(int64_t offsetNs);
+    int64_t offsetEstimate() const;
+
+    static const int OFFSET_WINDOW = 32;
+
+    const TimerClock &clock;
+
+    QHash<QObject *, PendingClick> pending;
+    int64_t offsets[OFFSET_WINDOW];
+    int offsetCount;
+    int offsetNext;
+};
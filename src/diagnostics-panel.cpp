@@ -0,0 +1,187 @@
+#include "diagnostics-panel.hpp"
+#include "load-generator.hpp"
+#include "timer-clock.hpp"
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPair>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QStandardPaths>
+#include <QStringConverter>
+#include <QTextStream>
+#include <QTimer>
+#include <QVBoxLayout>
+
+static QString formatMs(int64_t ns)
+{
+    return QString::number(static_cast<double>(ns) / NS_PER_MS, 'f', 3);
+}
+
+static QString summaryLine(const QString &title, const LatencyHistogram &histogram)
+{
+    return QString("%1  次数 %2  最小 %3  平均 %4  P50 %5  P90 %6  P99 %7  P99.9 %8  最大 %9 (ms)")
+        .arg(title)
+        .arg(histogram.count())
+        .arg(formatMs(histogram.minNs()), formatMs(histogram.meanNs()),
+             formatMs(histogram.percentileNs(50.0)), formatMs(histogram.percentileNs(90.0)),
+             formatMs(histogram.percentileNs(99.0)), formatMs(histogram.percentileNs(99.9)),
+             formatMs(histogram.maxNs()));
+}
+
+static QString bucketLines(const LatencyHistogram &histogram)
+{
+    QString text = "下界(ms)\t上界(ms)\t次数\n";
+    for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+        if (histogram.bucketHits(i) == 0) {
+            continue;
+        }
+        int64_t upper = LatencyHistogram::bucketUpperNs(i);
+        text += QString("%1\t%2\t%3\n")
+                    .arg(formatMs(LatencyHistogram::bucketLowerNs(i)),
+                         upper == INT64_MAX ? QString("-") : formatMs(upper))
+                    .arg(histogram.bucketHits(i));
+    }
+    return text;
+}
+
+DiagnosticsPanel::DiagnosticsPanel(TimingStats &stats, LoadGenerator *loadGenerator, QWidget *parent)
+    : QWidget(parent),
+      stats(stats),
+      loadGenerator(loadGenerator)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(10, 0, 10, 0);
+    layout->setSpacing(6);
+
+    summaryLabel = new QLabel(this);
+    summaryLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    summaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(summaryLabel);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    auto resetButton = new QPushButton("清零", this);
+    resetButton->setMinimumWidth(80);
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsPanel::resetStats);
+    buttons->addWidget(resetButton);
+
+    auto dumpButton = new QPushButton("导出统计", this);
+    dumpButton->setMinimumWidth(80);
+    connect(dumpButton, &QPushButton::clicked, this, &DiagnosticsPanel::dumpToFile);
+    buttons->addWidget(dumpButton);
+    buttons->addStretch();
+    layout->addLayout(buttons);
+
+    // 压力测试
+    QHBoxLayout *load = new QHBoxLayout();
+    load->addWidget(new QLabel("压力测试:", this));
+    loadRateSpin = new QSpinBox(this);
+    loadRateSpin->setRange(1, 5000);
+    loadRateSpin->setValue(20);
+    loadRateSpin->setSuffix(" 次/秒");
+    load->addWidget(loadRateSpin);
+
+    loadButton = new QPushButton("开始", this);
+    loadButton->setMinimumWidth(80);
+    connect(loadButton, &QPushButton::clicked, this, &DiagnosticsPanel::toggleLoad);
+    load->addWidget(loadButton);
+    load->addStretch();
+    layout->addLayout(load);
+
+    loadLabel = new QLabel(this);
+    loadLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    loadLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    loadLabel->setWordWrap(true);
+    connect(loadGenerator, &LoadGenerator::report, loadLabel, &QLabel::setText);
+    layout->addWidget(loadLabel);
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(1000);
+    connect(refreshTimer, &QTimer::timeout, this, &DiagnosticsPanel::refresh);
+}
+
+QString DiagnosticsPanel::reportText(bool withBuckets) const
+{
+    const QPair<QString, const LatencyHistogram *> histograms[] = {
+        {"刷新延迟", &stats.tickLateness},
+        {"刷新耗时", &stats.tickProcessing},
+        {"点击延迟", &stats.clickLatency},
+    };
+
+    QString text;
+    for (const auto &entry : histograms) {
+        text += summaryLine(entry.first, *entry.second) + "\n";
+    }
+    if (withBuckets) {
+        for (const auto &entry : histograms) {
+            text += "\n[" + entry.first + "]\n" + bucketLines(*entry.second);
+        }
+    }
+    return text;
+}
+
+void DiagnosticsPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer->start();
+}
+
+void DiagnosticsPanel::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    refreshTimer->stop();
+}
+
+void DiagnosticsPanel::refresh()
+{
+    summaryLabel->setText(reportText(false).trimmed());
+}
+
+void DiagnosticsPanel::resetStats()
+{
+    stats.tickLateness.reset();
+    stats.tickProcessing.reset();
+    stats.clickLatency.reset();
+    refresh();
+}
+
+void DiagnosticsPanel::toggleLoad()
+{
+    if (loadGenerator->isRunning()) {
+        loadGenerator->stop();
+    } else {
+        loadGenerator->start(loadRateSpin->value());
+    }
+    loadButton->setText(loadGenerator->isRunning() ? "停止" : "开始");
+    loadRateSpin->setEnabled(!loadGenerator->isRunning());
+}
+
+void DiagnosticsPanel::dumpToFile()
+{
+    QString defaultFileName = QString("Speech_Timer_Diagnostics_%1.txt")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    QString filePath = QFileDialog::getSaveFileName(this,
+        tr("保存诊断统计"),
+        defaultPath + "/" + defaultFileName,
+        tr("文本文件 (*.txt)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        Q_EMIT message("保存文件失败");
+        return;
+    }
+    QTextStream stream(&file);
+    stream.setEncoding(QStringConverter::Utf8);
+    stream << "导出时间: " << QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") << "\n\n";
+    stream << reportText(true);
+    file.close();
+    Q_EMIT message("文件已保存");
+}
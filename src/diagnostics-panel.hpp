@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QWidget>
+#include "latency-histogram.hpp"
+
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QTimer;
+class LoadGenerator;
+
+// 计时精度的统计，在界面线程中记录
+struct TimingStats {
+    LatencyHistogram tickLateness;    // 刷新比预定的整秒晚了多少
+    LatencyHistogram tickProcessing;  // 每次刷新本身的耗时
+    LatencyHistogram clickLatency;    // 从点击到计时线程记录完成
+};
+
+// 隐藏的诊断面板（Ctrl+Shift+D 切换）：显示各直方图的分位数，可以清零或把完整分布导出到文件，
+// 用于在活动结束后证明计时精度。只在可见时每秒刷新一次。
+// 压力测试也在这里启动和停止，并显示最近一次报告
+class DiagnosticsPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    DiagnosticsPanel(TimingStats &stats, LoadGenerator *loadGenerator, QWidget *parent = nullptr);
+
+    // withBuckets 为 true 时附带每个非空桶的计数
+    QString reportText(bool withBuckets) const;
+
+Q_SIGNALS:
+    void message(const QString &text);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    void refresh();
+    void resetStats();
+    void dumpToFile();
+    void toggleLoad();
+
+    TimingStats &stats;
+    LoadGenerator *loadGenerator;
+    QLabel *summaryLabel;
+    QSpinBox *loadRateSpin;
+    QPushButton *loadButton;
+    QLabel *loadLabel;
+    QTimer *refreshTimer;
+};
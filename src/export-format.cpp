@@ -0,0 +1,201 @@
+#include "export-format.hpp"
+#include "time-format.hpp"
+#include <QDateTime>
+#include <QTextStream>
+
+namespace {
+
+// 列宽
+const int ROLE_WIDTH = 12;      // "讨论嘉宾" 长度为4个汉字
+const int MIN_NAME_WIDTH = 8;   // 至少保留8个字符的宽度
+const int TIME_WIDTH = 8;       // "HH:mm:ss" 长度为8
+const int DURATION_WIDTH = 5;   // "mm:ss" 长度为5
+const int STATUS_WIDTH = 4;     // "是/否" 长度为2个汉字
+
+QString recordName(const TimerRecord &record)
+{
+    return record.name.empty() ? "(未填写)" : QString::fromStdString(record.name);
+}
+
+void writeTextRow(QTextStream &out, int nameWidth, const QString &role, const QString &name,
+                  const QString &startTime, const QString &endTime, const QString &duration,
+                  const QString &status)
+{
+    out << QString("%1\t%2\t%3\t%4\t%5\t%6\n")
+        .arg(role, -ROLE_WIDTH)
+        .arg(name, -nameWidth)
+        .arg(startTime, -TIME_WIDTH)
+        .arg(endTime, -TIME_WIDTH)
+        .arg(duration, -DURATION_WIDTH)
+        .arg(status, -STATUS_WIDTH);
+}
+
+void writeCsvRow(QTextStream &out, const QString &role, const QString &name, const QString &startTime,
+                 const QString &endTime, const QString &duration, const QString &status)
+{
+    out << role << ',' << name << ',' << startTime << ',' << endTime << ',' << duration << ',' << status << '\n';
+}
+
+// Excel 的时间和时长以天为单位；与文本导出一样只精确到秒
+double clockTimeValue(const WallClockAnchor &anchor, int64_t ns)
+{
+    int msecs = QDateTime::fromMSecsSinceEpoch(anchor.toWallMs(ns)).time().msecsSinceStartOfDay();
+    return (msecs / 1000) / 86400.0;
+}
+
+double durationValue(int64_t ns)
+{
+    int64_t secs = ns > 0 ? ns / NS_PER_SEC : 0;
+    return secs / 86400.0;
+}
+
+}  // namespace
+
+bool writeExport(ExportFormat format, const TimerEngine &engine, int64_t nowNs, QTextStream &out,
+                 const ExportProgress &progress)
+{
+    // 文本格式需要先找到最长的名字来确定列宽
+    int nameWidth = MIN_NAME_WIDTH;
+    if (format == ExportFormat::Text) {
+        for (RecordId id = engine.firstRecord(); id != NO_ID; id = engine.nextRecord(id)) {
+            nameWidth = qMax(nameWidth, static_cast<int>(QString::fromStdString(engine.findRecord(id)->name).length()));
+        }
+        writeTextRow(out, nameWidth, "角色", "姓名", "开始时间", "结束时间", "累计时间", "是否达标");
+    } else {
+        writeCsvRow(out, "角色", "姓名", "开始时间", "结束时间", "累计时间", "是否达标");
+    }
+
+    int total = engine.recordCount();
+    int done = 0;
+    for (RecordId id = engine.firstRecord(); id != NO_ID; id = engine.nextRecord(id)) {
+        const auto &record = *engine.findRecord(id);
+        QString role = speakerTypeName(record.type);
+        QString name = recordName(record);
+        QString status = engine.isMinTimeReached(id, nowNs) ? "是" : "否";
+
+        // 处理CSV中的特殊字符
+        if (format == ExportFormat::Csv && name.contains(",")) {
+            name = QString("\"%1\"").arg(name);
+        }
+
+        for (SegmentId segmentId : record.segments) {
+            const auto &segment = *engine.findSegment(segmentId);
+            if (!segment.isStarted()) {
+                continue;
+            }
+            QString startTime = formatClockTime(engine.wallAnchor(), segment.startNs);
+            QString endTime = segment.isEnded() ? formatClockTime(engine.wallAnchor(), segment.endNs) : "进行中";
+            QString duration = formatDuration(segment.durationNs(nowNs));
+
+            if (format == ExportFormat::Text) {
+                writeTextRow(out, nameWidth, role, name, startTime, endTime, duration, status);
+            } else {
+                writeCsvRow(out, role, name, startTime, endTime, duration, status);
+            }
+        }
+
+        if (progress && !progress(++done, total)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeXlsxExport(const TimerEngine &engine, int64_t nowNs, const XlsxWriter::Sink &sink,
+                     const ExportProgress &progress)
+{
+    XlsxWriter out(sink, "计时记录", {ROLE_WIDTH, 16, 10, 10, 10, 10});
+    out.beginRow();
+    for (const char *title : {"角色", "姓名", "开始时间", "结束时间", "累计时间", "是否达标"}) {
+        out.addString(title, XlsxWriter::HeaderCell);
+    }
+    out.endRow();
+
+    int total = engine.recordCount();
+    int done = 0;
+    for (RecordId id = engine.firstRecord(); id != NO_ID; id = engine.nextRecord(id)) {
+        const auto &record = *engine.findRecord(id);
+        // 角色、姓名和达标状态在共享字符串表中只保存一次
+        std::string role = speakerTypeName(record.type).toStdString();
+        std::string name = record.name.empty() ? "(未填写)" : record.name;
+        const char *status = engine.isMinTimeReached(id, nowNs) ? "是" : "否";
+
+        for (SegmentId segmentId : record.segments) {
+            const auto &segment = *engine.findSegment(segmentId);
+            if (!segment.isStarted()) {
+                continue;
+            }
+            out.beginRow();
+            out.addString(role);
+            out.addString(name);
+            out.addNumber(clockTimeValue(engine.wallAnchor(), segment.startNs), XlsxWriter::ClockCell);
+            if (segment.isEnded()) {
+                out.addNumber(clockTimeValue(engine.wallAnchor(), segment.endNs), XlsxWriter::ClockCell);
+            } else {
+                out.addString("进行中");
+            }
+            out.addNumber(durationValue(segment.durationNs(nowNs)), XlsxWriter::DurationCell);
+            out.addString(status);
+            out.endRow();
+        }
+
+        if (!out.ok() || (progress && !progress(++done, total))) {
+            return false;
+        }
+    }
+    return out.finish();
+}
+
+static void writeStatsRow(XlsxWriter &out, const std::string &name, const SpeakerStats &stats)
+{
+    out.beginRow();
+    out.addString(name);
+    out.addNumber(stats.sessions);
+    out.addNumber(stats.appearances);
+    out.addNumber(durationValue(stats.airtimeNs), XlsxWriter::DurationCell);
+    out.addNumber(qRound64(stats.averageOverrunNs() / NS_PER_SEC));
+    out.addNumber(stats.minTimeMet);
+    out.addNumber(qRound(stats.minTimeMetRate() * 1000) / 10.0);
+    out.endRow();
+}
+
+bool writeAnalyticsXlsx(const SessionAnalytics &analytics, const XlsxWriter::Sink &sink)
+{
+    XlsxWriter out(sink, "历史统计", {16, 8, 10, 12, 18, 10, 12});
+    out.beginRow();
+    for (const char *title : {"姓名/角色", "会话数", "发言次数", "累计时间", "平均超出最低时间(秒)", "达标次数",
+                              "达标比例(%)"}) {
+        out.addString(title, XlsxWriter::HeaderCell);
+    }
+    out.endRow();
+
+    for (SpeakerType type : {SpeakerType::Speaker, SpeakerType::Discussant}) {
+        writeStatsRow(out, "全部" + speakerTypeName(type).toStdString(), analytics.roles[static_cast<int>(type)]);
+    }
+    for (const SessionAnalytics::Speaker &speaker : analytics.speakers) {
+        writeStatsRow(out, speaker.name.empty() ? "(未填写)" : speaker.name, speaker.stats);
+        if (!out.ok()) {
+            return false;
+        }
+    }
+    return out.finish();
+}
+
+static QString formatExport(ExportFormat format, const TimerEngine &engine, int64_t nowNs)
+{
+    QString text;
+    QTextStream out(&text);
+    writeExport(format, engine, nowNs, out);
+    out.flush();
+    return text;
+}
+
+QString formatTextExport(const TimerEngine &engine, int64_t nowNs)
+{
+    return formatExport(ExportFormat::Text, engine, nowNs);
+}
+
+QString formatCsvExport(const TimerEngine &engine, int64_t nowNs)
+{
+    return formatExport(ExportFormat::Csv, engine, nowNs);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QString>
+#include <functional>
+#include "session-analytics.hpp"
+#include "timer-engine.hpp"
+#include "xlsx-writer.hpp"
+
+class QTextStream;
+
+// 导出文件的内容。只读取计时模型的一份副本，不涉及界面，可以在任意线程调用；
+// 所有时长按同一时刻 nowNs 计算
+
+enum class ExportFormat {
+    Text,  // 按列对齐的文本，列之间以制表符分隔
+    Csv,   // 供 Excel 打开的 CSV
+    Xlsx   // Excel 工作簿，时间和时长为数值单元格
+};
+
+// 进度回调：已处理的记录数和记录总数，返回 false 时中止导出
+typedef std::function<bool(int done, int total)> ExportProgress;
+
+// format 为 Text 或 Csv。逐行写入 out，不在内存中拼接整个文件；不写 BOM。被 progress 中止时返回 false
+bool writeExport(ExportFormat format, const TimerEngine &engine, int64_t nowNs, QTextStream &out,
+                 const ExportProgress &progress = ExportProgress());
+
+// 逐行写出只有一个工作表的 Excel 工作簿，文件内容交给 sink。写入失败或被 progress 中止时返回 false
+bool writeXlsxExport(const TimerEngine &engine, int64_t nowNs, const XlsxWriter::Sink &sink,
+                     const ExportProgress &progress = ExportProgress());
+
+// 历史统计的工作簿：先是每个角色的汇总，再是每位讲者，超出最低时间以秒为单位。写入失败时返回 false
+bool writeAnalyticsXlsx(const SessionAnalytics &analytics, const XlsxWriter::Sink &sink);
+
+// 整个导出内容，用于较小的导出和基准测试
+QString formatTextExport(const TimerEngine &engine, int64_t nowNs);
+QString formatCsvExport(const TimerEngine &engine, int64_t nowNs);
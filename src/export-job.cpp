@@ -0,0 +1,91 @@
+#include "export-job.hpp"
+#include "profile-scope.hpp"
+#include <QSaveFile>
+#include <QStringConverter>
+#include <QTextStream>
+#include <QThread>
+
+static bool writeEngineExport(ExportFormat format, const TimerEngine &engine, int64_t nowNs, QSaveFile &file,
+                              const ExportProgress &progress)
+{
+    if (format == ExportFormat::Xlsx) {
+        ProfileScope profile(ProfileName::EXPORT_EXCEL);
+        return writeXlsxExport(engine, nowNs, [&file](const char *data, size_t size) {
+            return file.write(data, static_cast<qint64>(size)) == static_cast<qint64>(size);
+        }, progress);
+    }
+
+    if (format == ExportFormat::Csv) {
+        // 写入 UTF-8 BOM，以确保Excel正确识别中文
+        file.write("\xEF\xBB\xBF");
+    }
+    QTextStream stream(&file);
+    stream.setEncoding(QStringConverter::Utf8);
+    bool ok;
+    {
+        // 分析器的作用域按线程记录，格式化和写入都在导出线程上
+        ProfileScope profile(format == ExportFormat::Text ? ProfileName::EXPORT_TEXT : ProfileName::EXPORT_EXCEL);
+        ok = writeExport(format, engine, nowNs, stream, progress);
+        stream.flush();
+    }
+    return ok && stream.status() == QTextStream::Ok;
+}
+
+ExportJob::ExportJob(ExportFormat format, const TimerEngine &engine, int64_t nowNs, const QString &filePath,
+                     QObject *parent)
+    : QObject(parent),
+      filePath(filePath),
+      text(format != ExportFormat::Xlsx),
+      writer([format, engine, nowNs](QSaveFile &file, const ExportProgress &progress) {
+          return writeEngineExport(format, engine, nowNs, file, progress);
+      }),
+      cancelled(false),
+      thread(nullptr)
+{
+}
+
+ExportJob::ExportJob(const QString &filePath, Writer writer, QObject *parent)
+    : QObject(parent),
+      filePath(filePath),
+      text(false),
+      writer(std::move(writer)),
+      cancelled(false),
+      thread(nullptr)
+{
+}
+
+ExportJob::~ExportJob()
+{
+    if (thread) {
+        cancel();
+        thread->wait();
+        delete thread;
+    }
+}
+
+void ExportJob::start()
+{
+    thread = QThread::create([this]() { run(); });
+    thread->start(QThread::LowPriority);
+}
+
+void ExportJob::run()
+{
+    int reported = -1;
+    ExportProgress progress = [this, &reported](int done, int total) {
+        // 只在百分比变化时通知，信号不会堆积在界面线程的队列里
+        int percent = total > 0 ? static_cast<int>(static_cast<int64_t>(done) * 100 / total) : 100;
+        if (percent != reported) {
+            reported = percent;
+            Q_EMIT progressChanged(percent);
+        }
+        return !cancelled.load();
+    };
+
+    // 没有提交的 QSaveFile 在析构时丢弃临时文件
+    QSaveFile file(filePath);
+    bool ok = file.open(text ? QIODevice::WriteOnly | QIODevice::Text : QIODevice::WriteOnly);
+    ok = ok && writer(file, progress);
+    ok = ok && file.commit();
+    Q_EMIT finished(ok);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include "export-format.hpp"
+
+class QSaveFile;
+class QThread;
+
+// 在工作线程上把计时模型的副本（或 Writer 生成的其他内容）导出到文件：逐行写入带缓冲的 QSaveFile，
+// 全部写完后才原子地替换目标文件，中途失败或取消时目标文件保持原样。
+// 进度和结果通过信号回到创建它的线程，导出期间界面线程不做任何格式化或磁盘操作
+class ExportJob : public QObject {
+    Q_OBJECT
+
+public:
+    // 在工作线程上写入已打开的 file，返回 false 表示失败或被 progress 中止
+    typedef std::function<bool(QSaveFile &file, const ExportProgress &progress)> Writer;
+
+    ExportJob(ExportFormat format, const TimerEngine &engine, int64_t nowNs, const QString &filePath,
+              QObject *parent = nullptr);
+    // 以二进制方式打开 filePath，由 writer 写入全部内容
+    ExportJob(const QString &filePath, Writer writer, QObject *parent = nullptr);
+    // 取消并等待工作线程结束
+    ~ExportJob();
+
+    void start();
+    void cancel() { cancelled = true; }
+
+Q_SIGNALS:
+    void progressChanged(int percent);
+    void finished(bool ok);
+
+private:
+    void run();  // 工作线程
+
+    const QString filePath;
+    const bool text;  // 以文本方式打开文件
+    const Writer writer;
+    std::atomic<bool> cancelled;
+    QThread *thread;
+};
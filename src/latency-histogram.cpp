@@ -0,0 +1,93 @@
+#include "latency-histogram.hpp"
+#include "timer-clock.hpp"
+#include <algorithm>
+
+static const int HALF_BUCKETS = LatencyHistogram::SUB_BUCKETS / 2;
+static const int64_t NS_PER_US = 1000;
+
+static int highestBit(uint64_t value)
+{
+    int bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record(int64_t ns)
+{
+    ns = std::max<int64_t>(ns, 0);
+    ++buckets[bucketIndex(static_cast<uint64_t>(ns / NS_PER_US))];
+    minValueNs = total ? std::min(minValueNs, ns) : ns;
+    maxValueNs = std::max(maxValueNs, ns);
+    sumNs += ns;
+    ++total;
+}
+
+void LatencyHistogram::reset()
+{
+    std::fill(buckets, buckets + BUCKET_COUNT, 0);
+    total = 0;
+    minValueNs = 0;
+    maxValueNs = 0;
+    sumNs = 0;
+}
+
+int64_t LatencyHistogram::percentileNs(double percentile) const
+{
+    if (total == 0) {
+        return 0;
+    }
+    // 第 rank 个样本（从 1 起）所在的桶
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+    rank = std::min(std::max<uint64_t>(rank, 1), total);
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(bucketUpperNs(i), maxValueNs);
+        }
+    }
+    return maxValueNs;
+}
+
+int64_t LatencyHistogram::bucketLowerNs(int index)
+{
+    return static_cast<int64_t>(bucketLowerUs(index)) * NS_PER_US;
+}
+
+int64_t LatencyHistogram::bucketUpperNs(int index)
+{
+    // 最后一个桶没有上界
+    if (index == BUCKET_COUNT - 1) {
+        return INT64_MAX;
+    }
+    return static_cast<int64_t>(bucketLowerUs(index + 1)) * NS_PER_US - 1;
+}
+
+int LatencyHistogram::bucketIndex(uint64_t us)
+{
+    if (us < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<int>(us);
+    }
+    // 最高位之后保留 4 位作为子桶
+    int shift = highestBit(us) - highestBit(HALF_BUCKETS);
+    int index = SUB_BUCKETS + (shift - 1) * HALF_BUCKETS + static_cast<int>(us >> shift) - HALF_BUCKETS;
+    return std::min(index, BUCKET_COUNT - 1);
+}
+
+uint64_t LatencyHistogram::bucketLowerUs(int index)
+{
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+    int offset = index - SUB_BUCKETS;
+    int shift = offset / HALF_BUCKETS + 1;
+    uint64_t sub = static_cast<uint64_t>(offset % HALF_BUCKETS + HALF_BUCKETS);
+    return sub << shift;
+}
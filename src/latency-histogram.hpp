@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+// 固定桶的延迟直方图（HDR 风格的对数-线性分桶）：以微秒计，
+// 每个 2 的幂区间再等分为 16 个子桶，相对误差不超过 1/16；
+// 超过约 71 分钟的值计入最后一个桶。
+// 记录为 O(1)，不分配内存，适合在每次刷新和每次点击时调用。
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKETS = 32;  // 小于 32 µs 的值每微秒一个桶
+    static const int BUCKET_COUNT = SUB_BUCKETS + 27 * (SUB_BUCKETS / 2);
+
+    LatencyHistogram();
+
+    // 负值按 0 计
+    void record(int64_t ns);
+    void reset();
+
+    uint64_t count() const { return total; }
+    int64_t minNs() const { return total ? minValueNs : 0; }
+    int64_t maxNs() const { return maxValueNs; }
+    int64_t meanNs() const { return total ? static_cast<int64_t>(sumNs / static_cast<int64_t>(total)) : 0; }
+    // 不超过该值的样本占 percentile%（取所在桶的上界，不超过最大值）
+    int64_t percentileNs(double percentile) const;
+
+    // 逐桶读取，用于导出完整分布
+    uint64_t bucketHits(int index) const { return buckets[index]; }
+    static int64_t bucketLowerNs(int index);
+    static int64_t bucketUpperNs(int index);
+
+private:
+    static int bucketIndex(uint64_t us);
+    static uint64_t bucketLowerUs(int index);
+
+    uint64_t buckets[BUCKET_COUNT];
+    uint64_t total;
+    int64_t minValueNs;
+    int64_t maxValueNs;
+    int64_t sumNs;
+};
@@ -0,0 +1,210 @@
+#include "load-generator.hpp"
+#include "diagnostics-panel.hpp"
+#include <QTimer>
+#include <util/base.h>
+#include <util/platform.h>
+#include <vector>
+
+namespace {
+
+// 每条记录最后一个时段的状态，决定下一步可以做什么
+struct Candidate {
+    RecordId recordId;
+    SegmentId lastSegment;
+    int segments;
+    bool started;
+    bool ended;
+};
+
+struct LoadState {
+    std::vector<Candidate> records;
+    int segments;
+};
+
+}  // namespace
+
+LoadGenerator::LoadGenerator(TimerService &service, const TimingStats &stats, QObject *watched,
+                             const Actions &actions, QObject *parent)
+    : QObject(parent),
+      service(service),
+      stats(stats),
+      watched(watched),
+      actions(actions),
+      operationsPerSecond(1),
+      lastStepNs(0),
+      stepCredit(0),
+      random(std::random_device()()),
+      startNs(0),
+      operations(0),
+      baselineMemory(0),
+      baselineObjects(0)
+{
+    stepTimer = new QTimer(this);
+    connect(stepTimer, &QTimer::timeout, this, &LoadGenerator::onStepTimeout);
+
+    reportTimer = new QTimer(this);
+    reportTimer->setInterval(REPORT_INTERVAL_MS);
+    connect(reportTimer, &QTimer::timeout, this, &LoadGenerator::emitReport);
+}
+
+bool LoadGenerator::hasSessionData(const TimerEngine &engine)
+{
+    for (RecordId id = engine.firstRecord(); id != NO_ID; id = engine.nextRecord(id)) {
+        const TimerRecord *record = engine.findRecord(id);
+        if (!record->name.empty()) {
+            return true;
+        }
+        for (SegmentId segmentId : record->segments) {
+            if (engine.findSegment(segmentId)->isStarted()) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool LoadGenerator::start(int rate)
+{
+    // 压力测试会改名、结束和删除记录，这些修改还会写入会话日志，不能在真实的会话上进行
+    if (service.call([](TimerEngine &e) { return hasSessionData(e); })) {
+        Q_EMIT report("当前会话已有记录，请先重置所有记录再开始压力测试");
+        return false;
+    }
+
+    operationsPerSecond = qMax(1, rate);
+    // 定时器精度有限，每次触发按实际经过的时间执行相应的步数
+    int intervalMs = qMax(1, 1000 / operationsPerSecond);
+
+    actions.setJournaling(false);
+    startNs = timerNowNs();
+    lastStepNs = startNs;
+    stepCredit = 0;
+    operations = 0;
+    baselineMemory = os_get_proc_resident_size();
+    baselineObjects = static_cast<int>(watched->findChildren<QObject *>().size());
+
+    stepTimer->start(intervalMs);
+    reportTimer->start();
+    blog(LOG_INFO, "[obs-speech-timer] Load generator started at %d ops/s", operationsPerSecond);
+    emitReport();
+    return true;
+}
+
+void LoadGenerator::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+    stepTimer->stop();
+    reportTimer->stop();
+    emitReport();
+    blog(LOG_INFO, "[obs-speech-timer] Load generator stopped after %llu operations",
+         static_cast<unsigned long long>(operations));
+    // 生成的记录不属于任何真实会话，清空后再恢复日志
+    actions.clearSession();
+    actions.setJournaling(true);
+}
+
+bool LoadGenerator::isRunning() const
+{
+    return stepTimer->isActive();
+}
+
+void LoadGenerator::onStepTimeout()
+{
+    int64_t nowNs = timerNowNs();
+    stepCredit += static_cast<int64_t>(operationsPerSecond) * (nowNs - lastStepNs);
+    lastStepNs = nowNs;
+    int64_t steps = stepCredit / NS_PER_SEC;
+    stepCredit -= steps * NS_PER_SEC;
+    // 界面卡顿后不补做超过一秒的积压，否则恢复时会突发一大批操作
+    steps = qMin(steps, static_cast<int64_t>(operationsPerSecond));
+    for (int64_t i = 0; i < steps; ++i) {
+        step();
+    }
+}
+
+bool LoadGenerator::chance(double probability)
+{
+    return std::uniform_real_distribution<double>(0.0, 1.0)(random) < probability;
+}
+
+void LoadGenerator::step()
+{
+    LoadState state = service.call([](TimerEngine &e) {
+        LoadState result;
+        result.segments = 0;
+        result.records.reserve(static_cast<size_t>(e.recordCount()));
+        for (RecordId id = e.firstRecord(); id != NO_ID; id = e.nextRecord(id)) {
+            const TimerRecord *record = e.findRecord(id);
+            Candidate candidate{id, NO_ID, static_cast<int>(record->segments.size()), false, false};
+            if (!record->segments.empty()) {
+                const TimerSegment *segment = e.findSegment(record->segments.back());
+                candidate.lastSegment = segment->id;
+                candidate.started = segment->isStarted();
+                candidate.ended = segment->isEnded();
+            }
+            result.segments += candidate.segments;
+            result.records.push_back(candidate);
+        }
+        return result;
+    });
+    ++operations;
+
+    int recordCount = static_cast<int>(state.records.size());
+    if (recordCount < MAX_RECORDS && chance(0.1)) {
+        actions.addRecord();
+        return;
+    }
+
+    const Candidate &pick = state.records[std::uniform_int_distribution<int>(0, recordCount - 1)(random)];
+    ClickStamper::Stamp stamp{service.nowNs(), 0};
+    if (pick.lastSegment == NO_ID) {
+        actions.addSegment(pick.recordId);
+    } else if (!pick.started) {
+        actions.startSegment(pick.recordId, pick.lastSegment, stamp);
+    } else if (!pick.ended) {
+        actions.endSegment(pick.recordId, pick.lastSegment, stamp);
+    } else if (recordCount > 1 && chance(0.2)) {
+        // 与界面一致：只剩一条记录、一个时段时不删除
+        actions.deleteRecord(pick.recordId);
+    } else if (pick.segments > 1 && (pick.segments >= MAX_SEGMENTS || chance(0.3))) {
+        actions.deleteSegment(pick.recordId, pick.lastSegment);
+    } else {
+        actions.addSegment(pick.recordId);
+    }
+}
+
+void LoadGenerator::emitReport()
+{
+    auto counts = service.call([](TimerEngine &e) {
+        int segments = 0;
+        for (RecordId id = e.firstRecord(); id != NO_ID; id = e.nextRecord(id)) {
+            segments += static_cast<int>(e.findRecord(id)->segments.size());
+        }
+        return std::make_pair(e.recordCount(), segments);
+    });
+
+    int64_t elapsedSecs = (timerNowNs() - startNs) / NS_PER_SEC;
+    double memoryMb = static_cast<double>(os_get_proc_resident_size()) / (1024.0 * 1024.0);
+    double memoryDeltaMb = memoryMb - static_cast<double>(baselineMemory) / (1024.0 * 1024.0);
+    int objects = static_cast<int>(watched->findChildren<QObject *>().size());
+
+    QString text = QString("压力测试 %1:%2:%3  操作 %4  记录 %5  时段 %6  内存 %7 MB (%8)  对象 %9 (%10)  "
+                           "刷新 平均 %11 ms P99 %12 ms")
+        .arg(elapsedSecs / 3600, 2, 10, QChar('0'))
+        .arg(elapsedSecs / 60 % 60, 2, 10, QChar('0'))
+        .arg(elapsedSecs % 60, 2, 10, QChar('0'))
+        .arg(operations)
+        .arg(counts.first)
+        .arg(counts.second)
+        .arg(memoryMb, 0, 'f', 1)
+        .arg(memoryDeltaMb, 0, 'f', 1)
+        .arg(objects)
+        .arg(objects - baselineObjects)
+        .arg(static_cast<double>(stats.tickProcessing.meanNs()) / NS_PER_MS, 0, 'f', 3)
+        .arg(static_cast<double>(stats.tickProcessing.percentileNs(99.0)) / NS_PER_MS, 0, 'f', 3);
+
+    blog(LOG_INFO, "[obs-speech-timer] %s", text.toUtf8().constData());
+    Q_EMIT report(text);
+}
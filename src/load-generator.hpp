@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QObject>
+#include <functional>
+#include <random>
+#include "click-stamp.hpp"
+#include "timer-service.hpp"
+
+class QTimer;
+struct TimingStats;
+
+// 压力测试：按设定的频率随机执行与按钮相同的操作（添加/删除记录，添加/开始/结束/删除时段），
+// 模拟长时间、多场次的活动。记录数和每条记录的时段数有上限，运行一段时间后进入稳定状态；
+// 定期报告常驻内存、刷新耗时和 QObject 数量，稳定状态下内存或对象数持续增长说明有泄漏。
+// 操作的是当前会话，所以只在会话中没有真实数据时才能开始，结束时丢弃生成的全部记录；
+// 运行期间暂停会话日志，崩溃后不会把生成的记录当作上次的会话恢复
+class LoadGenerator : public QObject {
+    Q_OBJECT
+
+public:
+    // 与按钮连接的槽相同的入口
+    struct Actions {
+        std::function<void()> addRecord;
+        std::function<void(RecordId)> deleteRecord;
+        std::function<void(RecordId)> addSegment;
+        std::function<void(RecordId, SegmentId)> deleteSegment;
+        std::function<void(RecordId, SegmentId, const ClickStamper::Stamp &)> startSegment;
+        std::function<void(RecordId, SegmentId, const ClickStamper::Stamp &)> endSegment;
+        // 删除所有记录、不归档，回到新会话
+        std::function<void()> clearSession;
+        // 暂停或恢复会话日志
+        std::function<void(bool enabled)> setJournaling;
+    };
+
+    // watched 及其所有子对象计入对象数量
+    LoadGenerator(TimerService &service, const TimingStats &stats, QObject *watched, const Actions &actions,
+                  QObject *parent = nullptr);
+
+    // 会话中有姓名或已开始的时段时拒绝开始，返回 false
+    bool start(int rate);
+    void stop();
+    bool isRunning() const;
+
+Q_SIGNALS:
+    void report(const QString &text);
+
+private:
+    void onStepTimeout();
+    void step();
+    void emitReport();
+    bool chance(double probability);
+    static bool hasSessionData(const TimerEngine &engine);
+
+    static const int MAX_RECORDS = 50;
+    static const int MAX_SEGMENTS = 20;
+    static const int REPORT_INTERVAL_MS = 10000;
+
+    TimerService &service;
+    const TimingStats &stats;
+    QObject *watched;
+    Actions actions;
+
+    QTimer *stepTimer;
+    QTimer *reportTimer;
+    int operationsPerSecond;
+    int64_t lastStepNs;   // 上一次执行操作的时刻
+    int64_t stepCredit;   // 尚未执行的操作，单位为 操作·纳秒，保留不足一次的部分
+    std::mt19937 random;
+
+    int64_t startNs;
+    uint64_t operations;
+    uint64_t baselineMemory;
+    int baselineObjects;
+};
@@ -0,0 +1,115 @@
+#include "mapped-file.hpp"
+#include <filesystem>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : base(nullptr),
+      length(0)
+#ifdef _WIN32
+      ,
+      mapping(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : MappedFile()
+{
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        std::swap(base, other.base);
+        std::swap(length, other.length);
+#ifdef _WIN32
+        std::swap(mapping, other.mapping);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(std::filesystem::u8path(path).c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+        CloseHandle(file);
+        return false;
+    }
+    // 映射对象持有文件，文件句柄可以立即关闭
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return false;
+    }
+    base = static_cast<const char *>(view);
+    length = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    // 映射建立后不再需要文件描述符
+    void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    base = static_cast<const char *>(view);
+    length = static_cast<size_t>(info.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!base) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    munmap(const_cast<char *>(base), length);
+#endif
+    base = nullptr;
+    length = 0;
+}
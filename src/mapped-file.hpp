@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// 只读映射整个文件，打开后内容直接按内存访问，不复制、不解析。
+// 映射在对象销毁或 close() 时解除；可以移动，不能复制
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // path 为 UTF-8；空文件无法映射，返回 false
+    bool open(const std::string &path);
+    void close();
+
+    const char *data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const char *base;
+    size_t length;
+#ifdef _WIN32
+    void *mapping;  // 文件映射对象的句柄
+#endif
+};
@@ -2,6 +2,7 @@
 #include <obs-frontend-api.h>
 #include <util/text-lookup.h>
 #include <util/util.hpp>
+#include <util/platform.h>
 #include <QMainWindow>
 #include <QApplication>
 #include <QMessageBox>
@@ -21,6 +22,7 @@ static lookup_t *lookup = nullptr;
 MODULE_EXPORT bool obs_module_load(void)
 {
     blog(LOG_INFO, "[obs-speech-timer] Loading plugin version %s", "1.0.0");
+    uint64_t loadStartNs = os_gettime_ns();
     
     try {
         if (!qApp) {
@@ -47,6 +49,17 @@ MODULE_EXPORT bool obs_module_load(void)
             return false;
         }
 
+        // 会话日志放在插件的配置目录，OBS 崩溃后下次加载时从中恢复
+        if (char *journalPath = obs_module_config_path("session.journal")) {
+            dock->setJournalPath(QString::fromUtf8(journalPath));
+            bfree(journalPath);
+        }
+        // 重置或关闭时的会话归档到配置目录下的 archive
+        if (char *archivePath = obs_module_config_path("archive")) {
+            dock->setArchiveDirectory(QString::fromUtf8(archivePath));
+            bfree(archivePath);
+        }
+
         blog(LOG_INFO, "[obs-speech-timer] Setting dock properties");
         dock->setObjectName("SpeechTimerDock");
         dock->setWindowTitle("Speech Timer");
@@ -65,7 +78,9 @@ MODULE_EXPORT bool obs_module_load(void)
             return false;
         }
 
-        blog(LOG_INFO, "[obs-speech-timer] Plugin loaded successfully");
+        // 停靠窗口的内容在第一次显示时才创建，这里只统计注册本身的耗时
+        blog(LOG_INFO, "[obs-speech-timer] Plugin loaded successfully in %.2f ms",
+             static_cast<double>(os_gettime_ns() - loadStartNs) / 1000000.0);
         return true;
     } catch (const std::exception& e) {
         blog(LOG_ERROR, "[obs-speech-timer] Exception during plugin load: %s", e.what());
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <util/profiler.h>
+
+// libobs 性能分析器中的各个作用域名。分析器按字符串地址区分作用域，
+// 所以开始和结束必须使用同一个常量
+namespace ProfileName {
+inline constexpr char UPDATE_ALL_TIMES[] = "SpeechTimer::updateAllTimes";
+inline constexpr char UPDATE_TOTAL_TIME[] = "SpeechTimer::updateTotalTime";
+inline constexpr char LAYOUT_ROWS[] = "SpeechTimer::layoutRows";
+inline constexpr char CREATE_ROW[] = "SpeechTimer::createRow";
+inline constexpr char DELETE_RECORD[] = "SpeechTimer::deleteRecord";
+inline constexpr char DELETE_SEGMENT[] = "SpeechTimer::deleteSegment";
+inline constexpr char EXPORT_TEXT[] = "SpeechTimer::exportToText";
+inline constexpr char EXPORT_EXCEL[] = "SpeechTimer::exportToExcel";
+}  // namespace ProfileName
+
+// 在当前作用域内计时，耗时出现在 OBS 的性能分析输出和退出时的日志汇总中
+class ProfileScope {
+public:
+    explicit ProfileScope(const char *name) : name(name) { profile_start(name); }
+    ~ProfileScope() { profile_end(name); }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *name;
+};
@@ -0,0 +1,489 @@
+#include "record-list-model.hpp"
+#include <algorithm>
+
+static int64_t shownSecs(int64_t ns)
+{
+    return ns > 0 ? ns / NS_PER_SEC : 0;
+}
+
+static bool sameDisplay(const TimeReading &a, const TimeReading &b)
+{
+    return shownSecs(a.ns) == shownSecs(b.ns) && a.state == b.state;
+}
+
+RecordListModel::RecordListModel(QObject *parent)
+    : QAbstractListModel(parent),
+      rows(0),
+      removedRecords(0),
+      indexValid(true),
+      rowStartsValid(true),
+      batchDepth(0)
+{
+}
+
+int RecordListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows;
+}
+
+QVariant RecordListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rows) {
+        return QVariant();
+    }
+
+    RowRef ref = rowRef(index.row());
+    const RecordItem &item = items[ref.record];
+
+    if (ref.segment < 0) {
+        switch (role) {
+        case KindRole:
+            return static_cast<int>(RecordRow);
+        case RecordIdRole:
+            return item.id;
+        case SegmentIdRole:
+            return NO_ID;
+        case Qt::DisplayRole:
+        case NameRole:
+            return item.name;
+        case TypeRole:
+            return static_cast<int>(item.type);
+        case ExpandedRole:
+            return item.expanded;
+        case CanDeleteRole:
+            return recordCount() > 1;
+        case TimeNsRole:
+            return QVariant::fromValue<qint64>(item.total.ns);
+        case TimeStateRole:
+            return static_cast<int>(item.total.state);
+        default:
+            return QVariant();
+        }
+    }
+
+    const SegmentItem &segment = item.segments[ref.segment];
+    switch (role) {
+    case KindRole:
+        return static_cast<int>(SegmentRow);
+    case RecordIdRole:
+        return item.id;
+    case SegmentIdRole:
+        return segment.id;
+    case CanDeleteRole:
+        return item.segments.size() > 1;
+    case TimeNsRole:
+        return QVariant::fromValue<qint64>(segment.time.ns);
+    case TimeStateRole:
+        return static_cast<int>(segment.time.state);
+    case StartNsRole:
+        return QVariant::fromValue<qint64>(segment.startNs);
+    case EndNsRole:
+        return QVariant::fromValue<qint64>(segment.endNs);
+    case StartLatencyRole:
+        return QVariant::fromValue<qint64>(segment.startLatencyNs);
+    case EndLatencyRole:
+        return QVariant::fromValue<qint64>(segment.endLatencyNs);
+    default:
+        return QVariant();
+    }
+}
+
+int RecordListModel::rowOfRecord(RecordId id) const
+{
+    int record = recordIndex(id);
+    return record < 0 ? -1 : firstRow(record);
+}
+
+bool RecordListModel::isExpanded(RecordId id) const
+{
+    int record = recordIndex(id);
+    return record >= 0 && items[record].expanded;
+}
+
+void RecordListModel::appendRecord(RecordId id, SpeakerType type)
+{
+    RecordItem item;
+    item.id = id;
+    item.type = type;
+    item.expanded = true;
+    item.removed = false;
+    item.total = TimeReading{0, TimeState::Zero};
+
+    beginInsert(rows, rows);
+    ensureIndex();
+    ensureRowStarts();
+    indexById.insert(id, static_cast<int>(items.size()));
+    rowStarts.append(rows);
+    items.append(item);
+    ++rows;
+    endInsert();
+
+    // 从一条变为两条时，第一条记录的删除按钮需要显示
+    if (recordCount() == 2) {
+        emitRowsChanged(0, 0, {CanDeleteRole});
+    }
+}
+
+void RecordListModel::removeRecord(RecordId id)
+{
+    int record = recordIndex(id);
+    if (record < 0) {
+        return;
+    }
+
+    int first = firstRow(record);
+    int count = 1 + visibleSegments(items[record]);
+    beginRemove(first, first + count - 1);
+    // 上面的查找已保证两张表有效，这里只做局部修正
+    indexById.remove(id);
+    if (record == items.size() - 1) {
+        // 末尾的记录直接去掉，连同它前面相连的墓碑，末尾追加的快速路径保持有效
+        items.removeLast();
+        rowStarts.removeLast();
+        while (!items.isEmpty() && items.last().removed) {
+            items.removeLast();
+            rowStarts.removeLast();
+            --removedRecords;
+        }
+    } else {
+        RecordItem &item = items[record];
+        item.removed = true;
+        item.name = QString();
+        item.segments = QVector<SegmentItem>();
+        ++removedRecords;
+        for (int i = record + 1; i < rowStarts.size(); ++i) {
+            rowStarts[i] -= count;
+        }
+    }
+    rows -= count;
+    endRemove();
+
+    if (recordCount() == 1) {
+        emitRowsChanged(0, 0, {CanDeleteRole});
+    }
+    if (removedRecords > recordCount()) {
+        compact();
+    }
+}
+
+void RecordListModel::appendSegment(RecordId recordId, SegmentId segmentId)
+{
+    int record = recordIndex(recordId);
+    if (record < 0) {
+        return;
+    }
+    RecordItem &item = items[record];
+    if (!item.expanded) {
+        return;
+    }
+
+    SegmentItem segment;
+    segment.id = segmentId;
+    segment.startNs = TIMER_NO_TIME;
+    segment.endNs = TIMER_NO_TIME;
+    segment.startLatencyNs = 0;
+    segment.endLatencyNs = 0;
+    segment.time = TimeReading{0, TimeState::Zero};
+
+    int row = firstRow(record) + 1 + static_cast<int>(item.segments.size());
+    beginInsert(row, row);
+    item.segments.append(segment);
+    ++rows;
+    // 追加到最后一条记录时后面没有行需要移动
+    if (record != items.size() - 1) {
+        rowStartsValid = false;
+    }
+    endInsert();
+
+    if (item.segments.size() == 2) {
+        emitSegmentChanged(record, 0, {CanDeleteRole});
+    }
+}
+
+void RecordListModel::removeSegment(RecordId recordId, SegmentId segmentId)
+{
+    int record = recordIndex(recordId);
+    if (record < 0) {
+        return;
+    }
+    RecordItem &item = items[record];
+    int segment = segmentIndex(item, segmentId);
+    if (segment < 0) {
+        return;
+    }
+
+    int row = firstRow(record) + 1 + segment;
+    beginRemove(row, row);
+    item.segments.remove(segment);
+    --rows;
+    rowStartsValid = false;
+    endRemove();
+
+    if (item.segments.size() == 1) {
+        emitSegmentChanged(record, 0, {CanDeleteRole});
+    }
+}
+
+void RecordListModel::expand(RecordId id, const QVector<SegmentItem> &segments)
+{
+    int record = recordIndex(id);
+    if (record < 0 || items[record].expanded) {
+        return;
+    }
+    RecordItem &item = items[record];
+    int first = firstRow(record);
+    int count = static_cast<int>(segments.size());
+
+    if (count == 0) {
+        item.expanded = true;
+    } else {
+        beginInsert(first + 1, first + count);
+        item.expanded = true;
+        item.segments = segments;
+        rows += count;
+        rowStartsValid = false;
+        endInsert();
+    }
+    emitRowsChanged(first, first, {ExpandedRole});
+}
+
+void RecordListModel::collapse(RecordId id)
+{
+    int record = recordIndex(id);
+    if (record < 0 || !items[record].expanded) {
+        return;
+    }
+    RecordItem &item = items[record];
+    int first = firstRow(record);
+    int count = static_cast<int>(item.segments.size());
+
+    if (count == 0) {
+        item.expanded = false;
+    } else {
+        beginRemove(first + 1, first + count);
+        item.expanded = false;
+        // 释放时段副本占用的内存，收起的记录只保留记录本身
+        item.segments = QVector<SegmentItem>();
+        rows -= count;
+        rowStartsValid = false;
+        endRemove();
+    }
+    emitRowsChanged(first, first, {ExpandedRole});
+}
+
+void RecordListModel::setName(RecordId id, const QString &name)
+{
+    int record = recordIndex(id);
+    if (record < 0 || items[record].name == name) {
+        return;
+    }
+    items[record].name = name;
+    int row = firstRow(record);
+    emitRowsChanged(row, row, {NameRole});
+}
+
+void RecordListModel::setType(RecordId id, SpeakerType type)
+{
+    int record = recordIndex(id);
+    if (record < 0 || items[record].type == type) {
+        return;
+    }
+    items[record].type = type;
+    int row = firstRow(record);
+    emitRowsChanged(row, row, {TypeRole});
+}
+
+void RecordListModel::setSegmentStart(RecordId recordId, SegmentId segmentId, int64_t ns, int64_t latencyNs)
+{
+    int record = recordIndex(recordId);
+    int segment = record < 0 ? -1 : segmentIndex(items[record], segmentId);
+    if (segment < 0) {
+        return;
+    }
+    SegmentItem &item = items[record].segments[segment];
+    item.startNs = ns;
+    item.startLatencyNs = latencyNs;
+    emitSegmentChanged(record, segment, {StartNsRole, StartLatencyRole});
+}
+
+void RecordListModel::setSegmentEnd(RecordId recordId, SegmentId segmentId, int64_t ns, int64_t latencyNs)
+{
+    int record = recordIndex(recordId);
+    int segment = record < 0 ? -1 : segmentIndex(items[record], segmentId);
+    if (segment < 0) {
+        return;
+    }
+    SegmentItem &item = items[record].segments[segment];
+    item.endNs = ns;
+    item.endLatencyNs = latencyNs;
+    emitSegmentChanged(record, segment, {EndNsRole, EndLatencyRole});
+}
+
+void RecordListModel::setTotalTime(RecordId id, const TimeReading &reading)
+{
+    int record = recordIndex(id);
+    if (record < 0) {
+        return;
+    }
+    RecordItem &item = items[record];
+    bool changed = !sameDisplay(item.total, reading);
+    item.total = reading;
+    if (changed) {
+        int row = firstRow(record);
+        emitRowsChanged(row, row, {TimeNsRole, TimeStateRole});
+    }
+}
+
+void RecordListModel::setSegmentTime(RecordId recordId, SegmentId segmentId, const TimeReading &reading)
+{
+    int record = recordIndex(recordId);
+    int segment = record < 0 ? -1 : segmentIndex(items[record], segmentId);
+    if (segment < 0) {
+        return;
+    }
+    SegmentItem &item = items[record].segments[segment];
+    bool changed = !sameDisplay(item.time, reading);
+    item.time = reading;
+    if (changed) {
+        emitSegmentChanged(record, segment, {TimeNsRole, TimeStateRole});
+    }
+}
+
+int RecordListModel::recordIndex(RecordId id) const
+{
+    ensureIndex();
+    return indexById.value(id, -1);
+}
+
+int RecordListModel::segmentIndex(const RecordItem &item, SegmentId id) const
+{
+    // 一条记录的时段很少，线性查找即可
+    for (int i = 0; i < item.segments.size(); ++i) {
+        if (item.segments[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int RecordListModel::firstRow(int record) const
+{
+    ensureRowStarts();
+    return rowStarts[record];
+}
+
+RecordListModel::RowRef RecordListModel::rowRef(int row) const
+{
+    ensureRowStarts();
+    // 最后一个起始行号不大于 row 的记录。墓碑不占行，起始行号与其后的记录相同，不会被选中
+    auto it = std::upper_bound(rowStarts.constBegin(), rowStarts.constEnd(), row);
+    int record = static_cast<int>(it - rowStarts.constBegin()) - 1;
+    return RowRef{record, row - rowStarts[record] - 1};
+}
+
+void RecordListModel::ensureIndex() const
+{
+    if (indexValid) {
+        return;
+    }
+    indexById.clear();
+    indexById.reserve(items.size());
+    for (int i = 0; i < items.size(); ++i) {
+        if (!items[i].removed) {
+            indexById.insert(items[i].id, i);
+        }
+    }
+    indexValid = true;
+}
+
+void RecordListModel::ensureRowStarts() const
+{
+    if (rowStartsValid) {
+        return;
+    }
+    rowStarts.resize(items.size());
+    int row = 0;
+    for (int i = 0; i < items.size(); ++i) {
+        rowStarts[i] = row;
+        row += items[i].removed ? 0 : 1 + visibleSegments(items[i]);
+    }
+    rowStartsValid = true;
+}
+
+void RecordListModel::compact()
+{
+    // 行不变，只是下标变了，不需要通知视图
+    items.erase(std::remove_if(items.begin(), items.end(), [](const RecordItem &item) { return item.removed; }),
+                items.end());
+    removedRecords = 0;
+    indexValid = false;
+    rowStartsValid = false;
+}
+
+void RecordListModel::beginBatch()
+{
+    if (batchDepth++ == 0) {
+        beginResetModel();
+    }
+}
+
+void RecordListModel::endBatch()
+{
+    if (--batchDepth == 0) {
+        endResetModel();
+    }
+}
+
+void RecordListModel::clear()
+{
+    beginBatch();
+    items.clear();
+    rows = 0;
+    removedRecords = 0;
+    indexValid = false;
+    rowStartsValid = false;
+    endBatch();
+}
+
+void RecordListModel::beginInsert(int first, int last)
+{
+    if (batchDepth == 0) {
+        beginInsertRows(QModelIndex(), first, last);
+    }
+}
+
+void RecordListModel::endInsert()
+{
+    if (batchDepth == 0) {
+        endInsertRows();
+    }
+}
+
+void RecordListModel::beginRemove(int first, int last)
+{
+    if (batchDepth == 0) {
+        beginRemoveRows(QModelIndex(), first, last);
+    }
+}
+
+void RecordListModel::endRemove()
+{
+    if (batchDepth == 0) {
+        endRemoveRows();
+    }
+}
+
+void RecordListModel::emitRowsChanged(int first, int last, const QList<int> &roles)
+{
+    // 批量修改结束时整体重置，期间不逐行通知
+    if (batchDepth > 0) {
+        return;
+    }
+    Q_EMIT dataChanged(index(first), index(last), roles);
+}
+
+void RecordListModel::emitSegmentChanged(int record, int segment, const QList<int> &roles)
+{
+    int row = firstRow(record) + 1 + segment;
+    emitRowsChanged(row, row, roles);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "timer-service.hpp"
+
+// 记录列表的界面模型：把记录和展开的记录的时段排成一维的行，
+// 行号由每条记录的起始行号（前缀和）换算，按行号查找为 O(log n)。
+// 删除的记录先留作不占行的墓碑，其余记录的下标不变，墓碑多于记录时才整体压缩。
+// 计时数据以计时线程为准，这里只保存界面显示需要的副本；
+// 收起的记录只保存记录本身，时段在展开时才从计时线程取回。
+class RecordListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum RowKind {
+        RecordRow,
+        SegmentRow
+    };
+
+    enum Roles {
+        KindRole = Qt::UserRole + 1,
+        RecordIdRole,
+        SegmentIdRole,
+        NameRole,
+        TypeRole,
+        ExpandedRole,
+        CanDeleteRole,      // 只剩一条记录/一个时段时不允许删除
+        TimeNsRole,         // 记录行为累计时长，时段行为时段时长
+        TimeStateRole,
+        StartNsRole,        // 以下为时段行，未记录为 TIMER_NO_TIME
+        EndNsRole,
+        StartLatencyRole,
+        EndLatencyRole
+    };
+
+    struct SegmentItem {
+        SegmentId id;
+        int64_t startNs;
+        int64_t endNs;
+        int64_t startLatencyNs;
+        int64_t endLatencyNs;
+        TimeReading time;
+    };
+
+    explicit RecordListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    int recordCount() const { return static_cast<int>(items.size()) - removedRecords; }
+    int rowOfRecord(RecordId id) const;
+    bool isExpanded(RecordId id) const;
+
+    void appendRecord(RecordId id, SpeakerType type);
+    void removeRecord(RecordId id);
+    void appendSegment(RecordId recordId, SegmentId segmentId);
+    void removeSegment(RecordId recordId, SegmentId segmentId);
+    // 展开时传入记录的全部时段；收起时丢弃时段的副本
+    void expand(RecordId id, const QVector<SegmentItem> &segments);
+    void collapse(RecordId id);
+    void clear();
+
+    // 批量修改：两次调用之间的修改不逐行通知视图，结束时只发出一次 modelReset。
+    // 可以嵌套，最外层结束时才通知
+    void beginBatch();
+    void endBatch();
+
+    void setName(RecordId id, const QString &name);
+    void setType(RecordId id, SpeakerType type);
+    void setSegmentStart(RecordId recordId, SegmentId segmentId, int64_t ns, int64_t latencyNs);
+    void setSegmentEnd(RecordId recordId, SegmentId segmentId, int64_t ns, int64_t latencyNs);
+
+    // 收起的记录的时段不在模型中，对它们的修改直接忽略。
+    // 显示的整秒数和状态都不变时不发出 dataChanged
+    void setTotalTime(RecordId id, const TimeReading &reading);
+    void setSegmentTime(RecordId recordId, SegmentId segmentId, const TimeReading &reading);
+
+private:
+    struct RecordItem {
+        RecordId id;
+        QString name;
+        SpeakerType type;
+        bool expanded;
+        bool removed;  // 墓碑：已删除，不占行，不在 indexById 中
+        TimeReading total;
+        QVector<SegmentItem> segments;
+    };
+
+    // 行对应的记录下标和时段下标，记录行的时段下标为 -1
+    struct RowRef {
+        int record;
+        int segment;
+    };
+
+    // 收起的记录没有时段副本
+    int visibleSegments(const RecordItem &item) const { return static_cast<int>(item.segments.size()); }
+    int recordIndex(RecordId id) const;
+    int segmentIndex(const RecordItem &item, SegmentId id) const;
+    int firstRow(int record) const;
+    RowRef rowRef(int row) const;
+    void ensureIndex() const;
+    void ensureRowStarts() const;
+    void compact();
+    void beginInsert(int first, int last);
+    void endInsert();
+    void beginRemove(int first, int last);
+    void endRemove();
+    void emitRowsChanged(int first, int last, const QList<int> &roles);
+    void emitSegmentChanged(int record, int segment, const QList<int> &roles);
+
+    QVector<RecordItem> items;
+    int rows;
+    int removedRecords;  // items 中墓碑的数量
+
+    // 按需重建的查找表；追加和删除记录时增量维护，其余结构变化时整体失效
+    mutable QHash<RecordId, int> indexById;
+    mutable bool indexValid;
+    mutable QVector<int> rowStarts;
+    mutable bool rowStartsValid;
+
+    int batchDepth;
+};
@@ -0,0 +1,200 @@
+#include "record-list-view.hpp"
+#include "record-row-delegate.hpp"
+#include "profile-scope.hpp"
+#include <QAbstractItemModel>
+#include <QScrollBar>
+
+RecordListView::RecordListView(QWidget *parent)
+    : QAbstractScrollArea(parent),
+      model(nullptr),
+      delegate(nullptr),
+      rowHeight(0),
+      rowWidth(0),
+      firstVisible(0),
+      poolSize(0)
+{
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+}
+
+void RecordListView::setModel(QAbstractItemModel *value)
+{
+    model = value;
+    connect(model, &QAbstractItemModel::rowsInserted, this, &RecordListView::onRowsChanged);
+    connect(model, &QAbstractItemModel::rowsRemoved, this, &RecordListView::onRowsChanged);
+    connect(model, &QAbstractItemModel::modelReset, this, &RecordListView::onRowsChanged);
+    connect(model, &QAbstractItemModel::layoutChanged, this, &RecordListView::onRowsChanged);
+    connect(model, &QAbstractItemModel::dataChanged, this, &RecordListView::onDataChanged);
+    onRowsChanged();
+}
+
+void RecordListView::setDelegate(RecordRowDelegate *value)
+{
+    delegate = value;
+    resetRowSize();
+}
+
+void RecordListView::setPoolSize(int size)
+{
+    poolSize = qMax(0, size);
+    if (!delegate) {
+        return;
+    }
+
+    // 预先创建，避免第一次添加记录和时段时才分配控件
+    for (int kind = 0; kind < 2; ++kind) {
+        pool[kind].reserve(poolSize);
+        while (pool[kind].size() < poolSize) {
+            QWidget *widget = delegate->createRow(kind, viewport());
+            widget->hide();
+            pool[kind].append(widget);
+        }
+        while (pool[kind].size() > poolSize) {
+            pool[kind].takeLast()->deleteLater();
+        }
+    }
+}
+
+void RecordListView::resetRowSize()
+{
+    // 样式变化后行高可能改变，重新测量并重新排列
+    if (delegate) {
+        delegate->resetRowSize();
+    }
+    rowHeight = 0;
+    onRowsChanged();
+}
+
+void RecordListView::scrollToRow(int row)
+{
+    if (rowHeight == 0) {
+        return;
+    }
+    int y = row * rowHeight;
+    int top = verticalScrollBar()->value();
+    int height = viewport()->height();
+    if (y < top) {
+        verticalScrollBar()->setValue(y);
+    } else if (y + rowHeight > top + height) {
+        verticalScrollBar()->setValue(y + rowHeight - height);
+    }
+}
+
+void RecordListView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollRange();
+    layoutRows(false);
+}
+
+void RecordListView::scrollContentsBy(int, int)
+{
+    // 不滚动像素，直接按新的位置重新摆放可见行
+    layoutRows(false);
+}
+
+void RecordListView::onRowsChanged()
+{
+    updateScrollRange();
+    layoutRows(true);
+}
+
+void RecordListView::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    // 不可见的行没有控件，什么也不用做
+    int from = qMax(topLeft.row(), firstVisible);
+    int to = qMin(bottomRight.row(), firstVisible + static_cast<int>(visibleRows.size()) - 1);
+    for (int row = from; row <= to; ++row) {
+        delegate->bindRow(visibleRows[row - firstVisible], model->index(row, 0));
+    }
+}
+
+void RecordListView::updateScrollRange()
+{
+    if (!model || !delegate) {
+        return;
+    }
+    if (rowHeight == 0) {
+        QSize size = delegate->rowSize(viewport());
+        rowHeight = size.height() + ROW_SPACING;
+        rowWidth = size.width();
+    }
+
+    int contentHeight = model->rowCount() * rowHeight;
+    verticalScrollBar()->setPageStep(viewport()->height());
+    verticalScrollBar()->setSingleStep(qMax(1, rowHeight / 2));
+    verticalScrollBar()->setRange(0, qMax(0, contentHeight - viewport()->height()));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, qMax(0, rowWidth - viewport()->width()));
+}
+
+void RecordListView::layoutRows(bool rebind)
+{
+    if (!model || !delegate || rowHeight == 0) {
+        return;
+    }
+    ProfileScope profile(ProfileName::LAYOUT_ROWS);
+
+    int count = model->rowCount();
+    int top = verticalScrollBar()->value();
+    int left = horizontalScrollBar()->value();
+    int height = viewport()->height();
+    int width = qMax(rowWidth, viewport()->width());
+    int first = qMin(top / rowHeight, count);
+    int last = qMin(count, (top + height + rowHeight - 1) / rowHeight);  // 不含
+
+    // 仍然可见的记录/时段继续使用原来的控件
+    QHash<quint64, QWidget *> previous;
+    previous.swap(rowsByKey);
+    QVector<quint64> keys(last - first);
+    QVector<QWidget *> rows(last - first, nullptr);
+    for (int row = first; row < last; ++row) {
+        quint64 key = delegate->rowKey(model->index(row, 0));
+        keys[row - first] = key;
+        rows[row - first] = previous.take(key);
+    }
+
+    // 离开可见区域的控件放回对象池，留给新进入的行
+    for (auto it = previous.constBegin(); it != previous.constEnd(); ++it) {
+        releaseRow(RecordRowDelegate::keyKind(it.key()), it.value());
+    }
+
+    for (int i = 0; i < rows.size(); ++i) {
+        int row = first + i;
+        QWidget *widget = rows[i];
+        bool fresh = !widget;
+        if (fresh) {
+            widget = acquireRow(RecordRowDelegate::keyKind(keys[i]));
+            rows[i] = widget;
+        }
+        if (fresh || rebind) {
+            delegate->bindRow(widget, model->index(row, 0));
+        }
+        widget->setGeometry(-left, row * rowHeight - top, width, rowHeight - ROW_SPACING);
+        widget->show();
+        rowsByKey.insert(keys[i], widget);
+    }
+
+    firstVisible = first;
+    visibleRows = rows;
+}
+
+QWidget *RecordListView::acquireRow(int kind)
+{
+    if (pool[kind].isEmpty()) {
+        return delegate->createRow(kind, viewport());
+    }
+    return pool[kind].takeLast();
+}
+
+void RecordListView::releaseRow(int kind, QWidget *widget)
+{
+    widget->hide();
+    delegate->resetRow(kind, widget);
+    if (pool[kind].size() < poolSize) {
+        pool[kind].append(widget);
+    } else {
+        // 控件可能正处于自己的信号处理中（例如点击了删除），延迟释放
+        widget->deleteLater();
+    }
+}
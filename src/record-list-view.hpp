@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QAbstractScrollArea>
+#include <QHash>
+#include <QVector>
+
+class QAbstractItemModel;
+class QModelIndex;
+class RecordRowDelegate;
+
+// 虚拟化的记录列表视图：所有行等高，滚动位置直接换算出可见的行，
+// 只为可见行创建行控件。行控件按记录/时段的稳定标识保留，滚动和增删
+// 其他行时原来的控件继续使用，离开可见区域的控件放回对象池，留给新进入的行复用。
+class RecordListView : public QAbstractScrollArea {
+    Q_OBJECT
+
+public:
+    explicit RecordListView(QWidget *parent = nullptr);
+
+    void setModel(QAbstractItemModel *model);
+    void setDelegate(RecordRowDelegate *delegate);
+
+    // 每种行控件最多保留的空闲数量，并立即预先创建到这个数量
+    void setPoolSize(int size);
+
+    void scrollToRow(int row);
+    // 样式表变化后调用，重新测量行高
+    void resetRowSize();
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    void onRowsChanged();
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void updateScrollRange();
+    void layoutRows(bool rebind);
+    QWidget *acquireRow(int kind);
+    void releaseRow(int kind, QWidget *widget);
+
+    static const int ROW_SPACING = 6;
+
+    QAbstractItemModel *model;
+    RecordRowDelegate *delegate;
+    int rowHeight;  // 含行间距
+    int rowWidth;   // 行控件的最小宽度，窗口更窄时水平滚动
+
+    int firstVisible;                 // visibleRows[0] 对应的行
+    QVector<QWidget *> visibleRows;   // 当前可见的行控件，按行号排列
+    QHash<quint64, QWidget *> rowsByKey;  // 可见行控件按记录/时段标识索引
+
+    int poolSize;
+    QVector<QWidget *> pool[2];  // 隐藏的空闲行控件，按类型存放
+};
@@ -0,0 +1,284 @@
+#include "record-row-delegate.hpp"
+#include "record-list-model.hpp"
+#include "time-format.hpp"
+#include "profile-scope.hpp"
+#include <QApplication>
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QStyle>
+
+RecordRowWidget::RecordRowWidget(QWidget *parent)
+    : QWidget(parent),
+      recordId(NO_ID)
+{
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->setSpacing(6);
+
+    // Type combo
+    typeCombo = new QComboBox(this);
+    typeCombo->addItem(speakerTypeName(SpeakerType::Speaker), static_cast<int>(SpeakerType::Speaker));
+    typeCombo->addItem(speakerTypeName(SpeakerType::Discussant), static_cast<int>(SpeakerType::Discussant));
+    typeCombo->setFixedWidth(100);
+    layout->addWidget(typeCombo);
+
+    // Name edit
+    nameEdit = new QLineEdit(this);
+    nameEdit->setPlaceholderText("姓名");
+    nameEdit->setFixedWidth(100);
+    layout->addWidget(nameEdit);
+
+    // Add segment button
+    addButton = new QPushButton("+", this);
+    addButton->setMinimumWidth(80);
+    layout->addWidget(addButton);
+
+    // Collapse/Expand button
+    expandButton = new QPushButton("收起", this);
+    expandButton->setMinimumWidth(80);
+    layout->addWidget(expandButton);
+
+    // Total time label
+    totalLabel = new QLabel("累计: 00:00", this);
+    totalLabel->setMinimumWidth(80);
+    totalLabel->setAlignment(Qt::AlignCenter);
+    layout->addWidget(totalLabel);
+
+    // Delete button
+    deleteButton = new QPushButton("删除", this);
+    deleteButton->setMinimumWidth(80);
+    layout->addWidget(deleteButton);
+}
+
+SegmentRowWidget::SegmentRowWidget(QWidget *parent)
+    : QWidget(parent),
+      recordId(NO_ID),
+      segmentId(NO_ID)
+{
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    // 缩进到姓名之后，与所属记录对齐
+    layout->setContentsMargins(216, 0, 0, 0);
+    layout->setSpacing(6);
+
+    // Start button
+    startButton = new QPushButton("记录开始时间", this);
+    startButton->setMinimumWidth(80);
+    startButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    layout->addWidget(startButton);
+
+    // End button
+    endButton = new QPushButton("记录结束时间", this);
+    endButton->setMinimumWidth(80);
+    endButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    endButton->setEnabled(false);
+    layout->addWidget(endButton);
+
+    // Duration label
+    durationLabel = new QLabel("00:00", this);
+    durationLabel->setMinimumWidth(80);
+    durationLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    durationLabel->setAlignment(Qt::AlignCenter);
+    layout->addWidget(durationLabel);
+
+    // Delete button
+    deleteButton = new QPushButton("删除", this);
+    deleteButton->setMinimumWidth(80);
+    deleteButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    layout->addWidget(deleteButton);
+}
+
+RecordRowDelegate::RecordRowDelegate(ClickStamper *clickStamper, const WallClockAnchor &anchor, QObject *parent)
+    : QObject(parent),
+      clickStamper(clickStamper),
+      anchor(anchor)
+{
+}
+
+int RecordRowDelegate::rowKind(const QModelIndex &index) const
+{
+    return index.data(RecordListModel::KindRole).toInt();
+}
+
+quint64 RecordRowDelegate::rowKey(const QModelIndex &index) const
+{
+    int kind = rowKind(index);
+    uint id = index.data(kind == RecordListModel::RecordRow ? RecordListModel::RecordIdRole
+                                                            : RecordListModel::SegmentIdRole).toUInt();
+    return (static_cast<quint64>(kind) << 32) | id;
+}
+
+QWidget *RecordRowDelegate::createRow(int kind, QWidget *parent)
+{
+    ProfileScope profile(ProfileName::CREATE_ROW);
+    if (kind == RecordListModel::RecordRow) {
+        return createRecordRow(parent);
+    }
+    return createSegmentRow(parent);
+}
+
+void RecordRowDelegate::bindRow(QWidget *row, const QModelIndex &index)
+{
+    if (rowKind(index) == RecordListModel::RecordRow) {
+        bindRecordRow(static_cast<RecordRowWidget *>(row), index);
+    } else {
+        bindSegmentRow(static_cast<SegmentRowWidget *>(row), index);
+    }
+}
+
+void RecordRowDelegate::resetRow(int kind, QWidget *row)
+{
+    // 正在编辑的姓名框失去焦点，复用后不会把输入带到另一条记录
+    if (row->isAncestorOf(QApplication::focusWidget())) {
+        QApplication::focusWidget()->clearFocus();
+    }
+    if (kind == RecordListModel::RecordRow) {
+        static_cast<RecordRowWidget *>(row)->recordId = NO_ID;
+    } else {
+        SegmentRowWidget *segmentRow = static_cast<SegmentRowWidget *>(row);
+        segmentRow->recordId = NO_ID;
+        segmentRow->segmentId = NO_ID;
+    }
+}
+
+QSize RecordRowDelegate::rowSize(QWidget *parent)
+{
+    if (measuredSize.isValid()) {
+        return measuredSize;
+    }
+
+    // 用一行样本按当前样式测量，两种行统一使用较大的高度
+    QWidget *samples[] = {createRecordRow(parent), createSegmentRow(parent)};
+    int width = 0;
+    int height = 0;
+    for (QWidget *sample : samples) {
+        sample->ensurePolished();
+        QSize hint = sample->sizeHint();
+        width = qMax(width, sample->minimumSizeHint().width());
+        height = qMax(height, hint.height());
+        delete sample;
+    }
+    measuredSize = QSize(width, height);
+    return measuredSize;
+}
+
+RecordRowWidget *RecordRowDelegate::createRecordRow(QWidget *parent)
+{
+    RecordRowWidget *row = new RecordRowWidget(parent);
+    initTimeLabel(row->totalLabel);
+
+    connect(row->addButton, &QPushButton::clicked, this,
+            [this, row]() { Q_EMIT addSegmentClicked(row->recordId); });
+    connect(row->deleteButton, &QPushButton::clicked, this,
+            [this, row]() { Q_EMIT deleteRecordClicked(row->recordId); });
+    connect(row->expandButton, &QPushButton::clicked, this,
+            [this, row]() { Q_EMIT expandClicked(row->recordId); });
+    connect(row->typeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            [this, row](int idx) { Q_EMIT typeChanged(row->recordId, static_cast<SpeakerType>(idx)); });
+    connect(row->nameEdit, &QLineEdit::textChanged, this,
+            [this, row](const QString &text) { Q_EMIT nameChanged(row->recordId, text); });
+    return row;
+}
+
+SegmentRowWidget *RecordRowDelegate::createSegmentRow(QWidget *parent)
+{
+    SegmentRowWidget *row = new SegmentRowWidget(parent);
+    initTimeLabel(row->durationLabel);
+
+    // 开始/结束时间取自点击事件本身的时间戳
+    clickStamper->watch(row->startButton);
+    clickStamper->watch(row->endButton);
+
+    connect(row->startButton, &QPushButton::clicked, this, [this, row]() {
+        Q_EMIT startClicked(row->recordId, row->segmentId, clickStamper->take(row->startButton));
+    });
+    connect(row->endButton, &QPushButton::clicked, this, [this, row]() {
+        Q_EMIT endClicked(row->recordId, row->segmentId, clickStamper->take(row->endButton));
+    });
+    connect(row->deleteButton, &QPushButton::clicked, this,
+            [this, row]() { Q_EMIT deleteSegmentClicked(row->recordId, row->segmentId); });
+    return row;
+}
+
+void RecordRowDelegate::bindRecordRow(RecordRowWidget *row, const QModelIndex &index)
+{
+    row->recordId = index.data(RecordListModel::RecordIdRole).toUInt();
+
+    // 绑定时的赋值不是用户编辑，不发出信号；内容相同时不赋值，不打断正在输入的光标
+    int type = index.data(RecordListModel::TypeRole).toInt();
+    if (row->typeCombo->currentIndex() != type) {
+        QSignalBlocker blocker(row->typeCombo);
+        row->typeCombo->setCurrentIndex(type);
+    }
+    QString name = index.data(RecordListModel::NameRole).toString();
+    if (row->nameEdit->text() != name) {
+        QSignalBlocker blocker(row->nameEdit);
+        row->nameEdit->setText(name);
+    }
+
+    row->expandButton->setText(index.data(RecordListModel::ExpandedRole).toBool() ? "收起" : "展开");
+    row->deleteButton->setVisible(index.data(RecordListModel::CanDeleteRole).toBool());
+    updateTimeLabel(row->totalLabel, row->totalCache, "累计: ",
+                    index.data(RecordListModel::TimeNsRole).toLongLong(),
+                    static_cast<TimeState>(index.data(RecordListModel::TimeStateRole).toInt()));
+}
+
+void RecordRowDelegate::bindSegmentRow(SegmentRowWidget *row, const QModelIndex &index)
+{
+    row->recordId = index.data(RecordListModel::RecordIdRole).toUInt();
+    row->segmentId = index.data(RecordListModel::SegmentIdRole).toUInt();
+
+    int64_t startNs = index.data(RecordListModel::StartNsRole).toLongLong();
+    int64_t endNs = index.data(RecordListModel::EndNsRole).toLongLong();
+    bool started = startNs != TIMER_NO_TIME;
+    bool ended = endNs != TIMER_NO_TIME;
+
+    row->startButton->setEnabled(!started);
+    row->startButton->setText(started ? formatClockTime(anchor, startNs) : QString("记录开始时间"));
+    row->startButton->setToolTip(
+        started ? formatLatency(index.data(RecordListModel::StartLatencyRole).toLongLong()) : QString());
+    row->endButton->setEnabled(started && !ended);
+    row->endButton->setText(ended ? formatClockTime(anchor, endNs) : QString("记录结束时间"));
+    row->endButton->setToolTip(
+        ended ? formatLatency(index.data(RecordListModel::EndLatencyRole).toLongLong()) : QString());
+    row->deleteButton->setVisible(index.data(RecordListModel::CanDeleteRole).toBool());
+
+    updateTimeLabel(row->durationLabel, row->durationCache, QString(),
+                    index.data(RecordListModel::TimeNsRole).toLongLong(),
+                    static_cast<TimeState>(index.data(RecordListModel::TimeStateRole).toInt()));
+}
+
+void RecordRowDelegate::initTimeLabel(QLabel *label)
+{
+    label->setProperty("timeState", QString("zero"));
+}
+
+void RecordRowDelegate::applyTimeStyle(QLabel *label, TimeState &current, TimeState state)
+{
+    // 状态不变时不做任何样式工作
+    if (state == current) {
+        return;
+    }
+    current = state;
+
+    QString name = state == TimeState::Zero ? "zero" : (state == TimeState::Reached ? "reached" : "below");
+    label->setProperty("timeState", name);
+
+    // 动态属性变化后需要重新 polish 才会应用对应的样式
+    label->style()->unpolish(label);
+    label->style()->polish(label);
+}
+
+void RecordRowDelegate::updateTimeLabel(QLabel *label, TimeLabelCache &cache, const QString &prefix,
+                                        int64_t ns, TimeState state)
+{
+    // 显示精度为秒，同一秒内的多次刷新不触发 setText 和重绘
+    int64_t secs = ns > 0 ? ns / NS_PER_SEC : 0;
+    if (secs != cache.shownSecs) {
+        cache.shownSecs = secs;
+        label->setText(prefix + formatDuration(ns));
+    }
+    applyTimeStyle(label, cache.state, state);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QModelIndex>
+#include <QObject>
+#include <QWidget>
+#include "click-stamp.hpp"
+#include "timer-service.hpp"
+
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QPushButton;
+
+// 时间标签最近一次显示的内容，内容和状态都不变时刷新直接跳过该标签
+struct TimeLabelCache {
+    int64_t shownSecs;  // 显示的整秒数，文本由它唯一确定
+    TimeState state;    // 当前应用的样式状态
+
+    TimeLabelCache() : shownSecs(-1), state(TimeState::Zero) {}
+};
+
+// 记录行：类型、姓名、添加时段、展开/收起、累计时间、删除
+class RecordRowWidget : public QWidget {
+public:
+    explicit RecordRowWidget(QWidget *parent = nullptr);
+
+    RecordId recordId;  // 当前绑定的记录
+    QComboBox *typeCombo;
+    QLineEdit *nameEdit;
+    QPushButton *addButton;
+    QPushButton *expandButton;
+    QLabel *totalLabel;
+    QPushButton *deleteButton;
+    TimeLabelCache totalCache;
+};
+
+// 时段行：开始、结束、时长、删除
+class SegmentRowWidget : public QWidget {
+public:
+    explicit SegmentRowWidget(QWidget *parent = nullptr);
+
+    RecordId recordId;  // 当前绑定的时段
+    SegmentId segmentId;
+    QPushButton *startButton;
+    QPushButton *endButton;
+    QLabel *durationLabel;
+    QPushButton *deleteButton;
+    TimeLabelCache durationCache;
+};
+
+// 记录列表的行委托：为 RecordListView 创建行控件，并把模型中的一行数据绑定到控件上。
+// 行控件会被反复绑定到不同的行，信号只在创建时连接一次，触发时读取控件当前绑定的 ID。
+class RecordRowDelegate : public QObject {
+    Q_OBJECT
+
+public:
+    RecordRowDelegate(ClickStamper *clickStamper, const WallClockAnchor &anchor, QObject *parent = nullptr);
+
+    int rowKind(const QModelIndex &index) const;
+    // 行对应的记录或时段的稳定标识，视图据此在结构变化后继续使用同一个控件
+    quint64 rowKey(const QModelIndex &index) const;
+    static int keyKind(quint64 key) { return static_cast<int>(key >> 32); }
+
+    QWidget *createRow(int kind, QWidget *parent);
+    void bindRow(QWidget *row, const QModelIndex &index);
+    // 行控件放回对象池前解除绑定，空闲控件不再对应任何记录
+    void resetRow(int kind, QWidget *row);
+
+    // 两种行控件的最大高度和最小宽度，第一次调用时测量
+    QSize rowSize(QWidget *parent);
+    void resetRowSize() { measuredSize = QSize(); }
+
+Q_SIGNALS:
+    void addSegmentClicked(RecordId recordId);
+    void deleteRecordClicked(RecordId recordId);
+    void expandClicked(RecordId recordId);
+    void typeChanged(RecordId recordId, SpeakerType type);
+    void nameChanged(RecordId recordId, const QString &name);
+    void startClicked(RecordId recordId, SegmentId segmentId, const ClickStamper::Stamp &stamp);
+    void endClicked(RecordId recordId, SegmentId segmentId, const ClickStamper::Stamp &stamp);
+    void deleteSegmentClicked(RecordId recordId, SegmentId segmentId);
+
+private:
+    RecordRowWidget *createRecordRow(QWidget *parent);
+    SegmentRowWidget *createSegmentRow(QWidget *parent);
+    void bindRecordRow(RecordRowWidget *row, const QModelIndex &index);
+    void bindSegmentRow(SegmentRowWidget *row, const QModelIndex &index);
+
+    static void initTimeLabel(QLabel *label);
+    static void applyTimeStyle(QLabel *label, TimeState &current, TimeState state);
+    static void updateTimeLabel(QLabel *label, TimeLabelCache &cache, const QString &prefix,
+                                int64_t ns, TimeState state);
+
+    ClickStamper *clickStamper;
+    const WallClockAnchor &anchor;
+    QSize measuredSize;
+};
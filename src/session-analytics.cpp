@@ -0,0 +1,147 @@
+#include "session-analytics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+// 一个线程取走的会话数，较小的块让各线程的负担更平均
+static const size_t SESSIONS_PER_CHUNK = 64;
+// 每个线程至少分到的会话数，会话较少时不值得启动更多线程
+static const size_t SESSIONS_PER_THREAD = 512;
+
+namespace {
+
+// 一个线程的累计结果。姓名驻留为序号，string_view 指向映射的文件，合并之前不复制
+struct Partial {
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<std::string_view> names;
+    std::vector<SpeakerStats> speakers;
+    std::vector<size_t> lastSession;  // 各讲者最近出现的会话，用于会话只计一次
+    SpeakerStats roles[2];
+    size_t roleLastSession[2] = {SIZE_MAX, SIZE_MAX};
+
+    // 本会话中各记录的时长，复用以免每个会话都分配
+    std::vector<int64_t> recordNs;
+    std::vector<uint8_t> recordUsed;
+
+    uint32_t intern(std::string_view name)
+    {
+        auto inserted = ids.emplace(name, static_cast<uint32_t>(names.size()));
+        if (inserted.second) {
+            names.push_back(name);
+            speakers.emplace_back();
+            lastSession.push_back(SIZE_MAX);
+        }
+        return inserted.first->second;
+    }
+
+    void add(size_t index, const ArchivedSession &session);
+};
+
+void addAppearance(SpeakerStats &stats, size_t &lastSession, size_t index, int64_t totalNs, int64_t minNs)
+{
+    if (lastSession != index) {
+        lastSession = index;
+        ++stats.sessions;
+    }
+    ++stats.appearances;
+    stats.airtimeNs += totalNs;
+    stats.overrunNs += totalNs - minNs;
+    stats.minTimeMet += totalNs >= minNs ? 1 : 0;
+}
+
+void Partial::add(size_t index, const ArchivedSession &session)
+{
+    // 先顺序扫描时段的记录和时长两列，按记录累加
+    uint32_t recordCount = session.recordCount();
+    recordNs.assign(recordCount, 0);
+    recordUsed.assign(recordCount, 0);
+    const uint32_t *records = session.segmentRecord();
+    const int64_t *durations = session.segmentDurationNs();
+    for (uint32_t i = 0, n = session.segmentCount(); i < n; ++i) {
+        recordNs[records[i]] += durations[i];
+        recordUsed[records[i]] = 1;
+    }
+
+    const int64_t minNs[2] = {
+        session.minTimeMinutes(SpeakerType::Speaker) * NS_PER_MIN,
+        session.minTimeMinutes(SpeakerType::Discussant) * NS_PER_MIN,
+    };
+    for (uint32_t record = 0; record < recordCount; ++record) {
+        if (!recordUsed[record]) {
+            continue;
+        }
+        int role = static_cast<int>(session.recordRole(record));
+        uint32_t id = intern(session.recordName(record));
+        addAppearance(speakers[id], lastSession[id], index, recordNs[record], minNs[role]);
+        addAppearance(roles[role], roleLastSession[role], index, recordNs[record], minNs[role]);
+    }
+}
+
+void merge(SpeakerStats &into, const SpeakerStats &from)
+{
+    into.sessions += from.sessions;
+    into.appearances += from.appearances;
+    into.minTimeMet += from.minTimeMet;
+    into.airtimeNs += from.airtimeNs;
+    into.overrunNs += from.overrunNs;
+}
+
+} // namespace
+
+SessionAnalytics analyzeSessions(const std::vector<ArchivedSession> &sessions, int threads)
+{
+    size_t workers = threads > 0 ? static_cast<size_t>(threads) : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::max<size_t>(1, std::min(workers, sessions.size() / SESSIONS_PER_THREAD));
+
+    // 映射：各线程按块取会话，只写自己的 Partial。
+    // 每个会话只被一个线程处理，因此同一讲者在不同线程中的会话数可以直接相加
+    std::vector<Partial> partials(workers);
+    std::atomic<size_t> nextChunk(0);
+    auto run = [&sessions, &nextChunk](Partial &partial) {
+        for (;;) {
+            size_t begin = nextChunk.fetch_add(SESSIONS_PER_CHUNK);
+            if (begin >= sessions.size()) {
+                return;
+            }
+            size_t end = std::min(sessions.size(), begin + SESSIONS_PER_CHUNK);
+            for (size_t i = begin; i < end; ++i) {
+                partial.add(i, sessions[i]);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < workers; ++i) {
+        pool.emplace_back(run, std::ref(partials[i]));
+    }
+    run(partials[0]);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    // 归约：按姓名合并各线程的结果，每个姓名只在这里复制一次
+    SessionAnalytics result;
+    result.sessionCount = static_cast<int>(sessions.size());
+    std::unordered_map<std::string_view, size_t> index;
+    for (const Partial &partial : partials) {
+        for (int role = 0; role < 2; ++role) {
+            merge(result.roles[role], partial.roles[role]);
+        }
+        for (size_t id = 0; id < partial.names.size(); ++id) {
+            auto inserted = index.emplace(partial.names[id], result.speakers.size());
+            if (inserted.second) {
+                result.speakers.push_back({std::string(partial.names[id]), SpeakerStats()});
+            }
+            merge(result.speakers[inserted.first->second].stats, partial.speakers[id]);
+        }
+    }
+    std::sort(result.speakers.begin(), result.speakers.end(),
+              [](const SessionAnalytics::Speaker &a, const SessionAnalytics::Speaker &b) {
+                  if (a.stats.airtimeNs != b.stats.airtimeNs) {
+                      return a.stats.airtimeNs > b.stats.airtimeNs;
+                  }
+                  return a.name < b.name;
+              });
+    return result;
+}
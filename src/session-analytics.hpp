@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "session-archive.hpp"
+
+// 一组历史会话中某位讲者或某个角色的汇总。
+// 一条计时过的记录算一次发言；同一会话中同名的多条记录各算一次发言，但只算一个会话
+struct SpeakerStats {
+    int sessions = 0;       // 出现过的会话数
+    int appearances = 0;    // 发言次数
+    int minTimeMet = 0;     // 其中达到最低时间的次数
+    int64_t airtimeNs = 0;  // 全部时长
+    int64_t overrunNs = 0;  // 每次发言超出当时最低时间的部分之和，不足的记为负数
+
+    double averageOverrunNs() const { return appearances > 0 ? static_cast<double>(overrunNs) / appearances : 0.0; }
+    double minTimeMetRate() const { return appearances > 0 ? static_cast<double>(minTimeMet) / appearances : 0.0; }
+};
+
+struct SessionAnalytics {
+    struct Speaker {
+        std::string name;  // UTF-8，可能为空（未填写姓名）
+        SpeakerStats stats;
+    };
+
+    int sessionCount = 0;
+    SpeakerStats roles[2];          // 下标为 SpeakerType
+    std::vector<Speaker> speakers;  // 按姓名区分，全部时长从多到少
+};
+
+// 统计 sessions 中的全部会话。会话分块交给 threads 个线程（不大于 0 时为 CPU 核数）各自累计，
+// 每个线程把姓名驻留为序号，扫描时只按序号累加，最后按姓名合并。
+// 只读取映射的各列，不复制会话；各列的内容已在 ArchivedSession::open() 中校验
+SessionAnalytics analyzeSessions(const std::vector<ArchivedSession> &sessions, int threads = 0);
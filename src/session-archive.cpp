@@ -0,0 +1,234 @@
+#include "session-archive.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+static const char MAGIC[8] = {'S', 'T', 'A', 'R', 'C', 'H', 0, 1};
+// 角色列中合法的最大值
+static const uint8_t MAX_ROLE = static_cast<uint8_t>(SpeakerType::Discussant);
+
+const char SessionArchive::FILE_SUFFIX[] = ".stca";
+
+static_assert(sizeof(ArchiveHeader) == 40, "ArchiveHeader must have a fixed layout");
+
+static size_t align8(size_t offset)
+{
+    return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+ArchivedSession::Layout::Layout(uint32_t segmentCount, uint32_t recordCount, uint32_t stringBytes)
+{
+    segmentStarts = sizeof(ArchiveHeader);
+    segmentDurations = segmentStarts + segmentCount * sizeof(int64_t);
+    segmentRecords = segmentDurations + segmentCount * sizeof(int64_t);
+    segmentRoles = align8(segmentRecords + segmentCount * sizeof(uint32_t));
+    recordNameOffsets = align8(segmentRoles + segmentCount);
+    recordNameLengths = align8(recordNameOffsets + recordCount * sizeof(uint32_t));
+    recordRoles = align8(recordNameLengths + recordCount * sizeof(uint32_t));
+    strings = align8(recordRoles + recordCount);
+    size = strings + stringBytes;
+}
+
+bool ArchivedSession::open(const std::string &path)
+{
+    header = nullptr;
+    if (!file.open(path) || file.size() < sizeof(ArchiveHeader)) {
+        return false;
+    }
+    const ArchiveHeader *candidate = column<ArchiveHeader>(0);
+    if (std::memcmp(candidate->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    // 大小与计数对不上的文件（写了一半或被截断）不使用
+    layout = Layout(candidate->segmentCount, candidate->recordCount, candidate->stringBytes);
+    if (layout.size != file.size()) {
+        return false;
+    }
+    // 各列的内容只在这里校验一次，之后按下标读取时不再检查
+    const uint32_t *records = column<uint32_t>(layout.segmentRecords);
+    const uint8_t *segmentRoles = column<uint8_t>(layout.segmentRoles);
+    for (uint32_t i = 0; i < candidate->segmentCount; ++i) {
+        if (records[i] >= candidate->recordCount || segmentRoles[i] > MAX_ROLE) {
+            return false;
+        }
+    }
+    const uint32_t *offsets = column<uint32_t>(layout.recordNameOffsets);
+    const uint32_t *lengths = column<uint32_t>(layout.recordNameLengths);
+    const uint8_t *recordRoles = column<uint8_t>(layout.recordRoles);
+    for (uint32_t i = 0; i < candidate->recordCount; ++i) {
+        if (static_cast<uint64_t>(offsets[i]) + lengths[i] > candidate->stringBytes || recordRoles[i] > MAX_ROLE) {
+            return false;
+        }
+    }
+    header = candidate;
+    return true;
+}
+
+std::string_view ArchivedSession::recordName(uint32_t record) const
+{
+    uint32_t offset = column<uint32_t>(layout.recordNameOffsets)[record];
+    uint32_t length = column<uint32_t>(layout.recordNameLengths)[record];
+    return std::string_view(column<char>(layout.strings) + offset, length);
+}
+
+int64_t ArchivedSession::totalNs(SpeakerType type) const
+{
+    const uint8_t *roles = segmentRole();
+    const int64_t *durations = segmentDurationNs();
+    uint8_t role = static_cast<uint8_t>(type);
+    int64_t total = 0;
+    for (uint32_t i = 0, n = segmentCount(); i < n; ++i) {
+        total += roles[i] == role ? durations[i] : 0;
+    }
+    return total;
+}
+
+SessionArchive::SessionArchive(const std::string &directory)
+    : directory(directory)
+{
+}
+
+// 最早开始的时段的时刻，没有开始过的时段则为 TIMER_NO_TIME
+static int64_t firstStartNs(const TimerEngine &engine)
+{
+    int64_t firstNs = TIMER_NO_TIME;
+    for (RecordId id = engine.firstRecord(); id != NO_ID; id = engine.nextRecord(id)) {
+        for (SegmentId segmentId : engine.findRecord(id)->segments) {
+            const TimerSegment *segment = engine.findSegment(segmentId);
+            if (segment->isStarted() && (firstNs == TIMER_NO_TIME || segment->startNs < firstNs)) {
+                firstNs = segment->startNs;
+            }
+        }
+    }
+    return firstNs;
+}
+
+bool SessionArchive::add(const TimerEngine &engine, int64_t nowNs)
+{
+    int64_t firstNs = firstStartNs(engine);
+    if (firstNs == TIMER_NO_TIME) {
+        return true;
+    }
+
+    // 文件名取第一个时段开始的时间，同一时刻的会话加序号区分
+    std::filesystem::path folder = std::filesystem::u8path(directory);
+    std::error_code error;
+    std::filesystem::create_directories(folder, error);
+    std::string stem = "session-" + std::to_string(engine.wallAnchor().toWallMs(firstNs));
+    std::filesystem::path target = folder / std::filesystem::u8path(stem + FILE_SUFFIX);
+    for (int i = 1; std::filesystem::exists(target, error); ++i) {
+        target = folder / std::filesystem::u8path(stem + "-" + std::to_string(i) + FILE_SUFFIX);
+    }
+    return write(target.u8string(), engine, nowNs);
+}
+
+bool SessionArchive::write(const std::string &path, const TimerEngine &engine, int64_t nowNs)
+{
+    const WallClockAnchor &anchor = engine.wallAnchor();
+    const int64_t wallOffsetNs = anchor.wallMs * NS_PER_MS - anchor.monoNs;
+
+    std::vector<int64_t> starts;
+    std::vector<int64_t> durations;
+    std::vector<uint32_t> segmentRecords;
+    std::vector<uint8_t> segmentRoles;
+    std::vector<uint32_t> nameOffsets;
+    std::vector<uint32_t> nameLengths;
+    std::vector<uint8_t> recordRoles;
+    std::string strings;
+    std::unordered_map<std::string, uint32_t> stringIndex;  // 相同的姓名只存一次
+
+    for (RecordId id = engine.firstRecord(); id != NO_ID; id = engine.nextRecord(id)) {
+        const TimerRecord &record = *engine.findRecord(id);
+        uint32_t index = static_cast<uint32_t>(recordRoles.size());
+        auto inserted = stringIndex.emplace(record.name, static_cast<uint32_t>(strings.size()));
+        if (inserted.second) {
+            strings += record.name;
+        }
+        nameOffsets.push_back(inserted.first->second);
+        nameLengths.push_back(static_cast<uint32_t>(record.name.size()));
+        recordRoles.push_back(static_cast<uint8_t>(record.type));
+
+        for (SegmentId segmentId : record.segments) {
+            const TimerSegment &segment = *engine.findSegment(segmentId);
+            if (!segment.isStarted()) {
+                continue;
+            }
+            starts.push_back(segment.startNs + wallOffsetNs);
+            durations.push_back(segment.durationNs(nowNs));
+            segmentRecords.push_back(index);
+            segmentRoles.push_back(static_cast<uint8_t>(record.type));
+        }
+    }
+
+    ArchiveHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.segmentCount = static_cast<uint32_t>(starts.size());
+    header.recordCount = static_cast<uint32_t>(recordRoles.size());
+    header.startedNs = starts.empty() ? 0 : *std::min_element(starts.begin(), starts.end());
+    header.minTimeMinutes[static_cast<int>(SpeakerType::Speaker)] = engine.minTimeMinutes(SpeakerType::Speaker);
+    header.minTimeMinutes[static_cast<int>(SpeakerType::Discussant)] =
+        engine.minTimeMinutes(SpeakerType::Discussant);
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+
+    // 按布局拼出整个文件，各列之间的填充为 0
+    ArchivedSession::Layout layout(header.segmentCount, header.recordCount, header.stringBytes);
+    std::string data(layout.size, '\0');
+    auto put = [&data](size_t offset, const void *source, size_t size) {
+        if (size > 0) {
+            std::memcpy(&data[offset], source, size);
+        }
+    };
+    put(0, &header, sizeof(header));
+    put(layout.segmentStarts, starts.data(), starts.size() * sizeof(int64_t));
+    put(layout.segmentDurations, durations.data(), durations.size() * sizeof(int64_t));
+    put(layout.segmentRecords, segmentRecords.data(), segmentRecords.size() * sizeof(uint32_t));
+    put(layout.segmentRoles, segmentRoles.data(), segmentRoles.size());
+    put(layout.recordNameOffsets, nameOffsets.data(), nameOffsets.size() * sizeof(uint32_t));
+    put(layout.recordNameLengths, nameLengths.data(), nameLengths.size() * sizeof(uint32_t));
+    put(layout.recordRoles, recordRoles.data(), recordRoles.size());
+    put(layout.strings, strings.data(), strings.size());
+
+    // 写完整个临时文件、确认关闭成功后再改名，目录中不会出现写了一半的归档。
+    // 缓冲的数据在 close() 时才真正写出，磁盘满之类的错误要在关闭之后检查
+    std::filesystem::path target = std::filesystem::u8path(path);
+    std::filesystem::path temp = target;
+    temp += ".tmp";
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    out.close();
+    std::error_code error;
+    if (out.fail()) {
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    std::filesystem::rename(temp, target, error);
+    if (error) {
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    return true;
+}
+
+int SessionArchive::load()
+{
+    mapped.clear();
+    std::error_code error;
+    std::filesystem::directory_iterator it(std::filesystem::u8path(directory), error);
+    for (; !error && it != std::filesystem::directory_iterator(); it.increment(error)) {
+        const std::filesystem::path &path = it->path();
+        if (path.extension() != FILE_SUFFIX) {
+            continue;
+        }
+        ArchivedSession session;
+        if (session.open(path.u8string())) {
+            mapped.push_back(std::move(session));
+        }
+    }
+    std::sort(mapped.begin(), mapped.end(), [](const ArchivedSession &a, const ArchivedSession &b) {
+        return a.startedNs() < b.startedNs();
+    });
+    return static_cast<int>(mapped.size());
+}
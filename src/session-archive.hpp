@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mapped-file.hpp"
+#include "timer-engine.hpp"
+
+// 历史会话的归档：每场会话一个文件，时段按列存放（开始时间、时长、所属记录、角色各一个连续数组），
+// 记录的姓名放在去重的字符串表里。文件布局固定、按 8 字节对齐，打开时直接内存映射，
+// 统计只顺序扫描需要的列，不解析也不复制。数值按小端存放。
+// 打开时校验一次各列的内容，映射成功的会话中记录序号、角色和姓名位置都在范围内。
+//
+// 文件布局：
+//   ArchiveHeader
+//   int64_t  segmentStartNs[segmentCount]     墙上时间，自 Unix 纪元起的纳秒
+//   int64_t  segmentDurationNs[segmentCount]
+//   uint32_t segmentRecord[segmentCount]      记录在本会话中的序号
+//   uint8_t  segmentRole[segmentCount]        SpeakerType
+//   uint32_t recordNameOffset[recordCount]    在字符串表中的位置
+//   uint32_t recordNameLength[recordCount]
+//   uint8_t  recordRole[recordCount]
+//   char     strings[stringBytes]             UTF-8，不以 0 结尾
+// 每一列都从 8 字节对齐的位置开始。
+
+struct ArchiveHeader {
+    char magic[8];
+    uint32_t segmentCount;
+    uint32_t recordCount;
+    int64_t startedNs;           // 最早的时段开始时间，墙上时间
+    int32_t minTimeMinutes[2];   // 归档时的最低时间，下标为 SpeakerType
+    uint32_t stringBytes;
+    uint32_t reserved;
+};
+
+// 一个已映射的归档文件，各列直接指向映射的内存
+class ArchivedSession {
+public:
+    // 映射并校验文件头、大小和各列的内容（记录序号、角色、姓名的范围），失败时返回 false
+    bool open(const std::string &path);
+
+    int64_t startedNs() const { return header->startedNs; }
+    int minTimeMinutes(SpeakerType type) const { return header->minTimeMinutes[static_cast<int>(type)]; }
+
+    uint32_t segmentCount() const { return header->segmentCount; }
+    const int64_t *segmentStartNs() const { return column<int64_t>(layout.segmentStarts); }
+    const int64_t *segmentDurationNs() const { return column<int64_t>(layout.segmentDurations); }
+    const uint32_t *segmentRecord() const { return column<uint32_t>(layout.segmentRecords); }
+    const uint8_t *segmentRole() const { return column<uint8_t>(layout.segmentRoles); }
+
+    uint32_t recordCount() const { return header->recordCount; }
+    std::string_view recordName(uint32_t record) const;
+    SpeakerType recordRole(uint32_t record) const
+    {
+        return static_cast<SpeakerType>(column<uint8_t>(layout.recordRoles)[record]);
+    }
+
+    // 某一角色的全部时长，只扫描角色和时长两列
+    int64_t totalNs(SpeakerType type) const;
+
+    // 各列在文件中的位置
+    struct Layout {
+        size_t segmentStarts;
+        size_t segmentDurations;
+        size_t segmentRecords;
+        size_t segmentRoles;
+        size_t recordNameOffsets;
+        size_t recordNameLengths;
+        size_t recordRoles;
+        size_t strings;
+        size_t size;  // 整个文件
+
+        Layout(uint32_t segmentCount, uint32_t recordCount, uint32_t stringBytes);
+        Layout() : Layout(0, 0, 0) {}
+    };
+
+private:
+    template <typename T>
+    const T *column(size_t offset) const { return reinterpret_cast<const T *>(file.data() + offset); }
+
+    MappedFile file;
+    const ArchiveHeader *header = nullptr;
+    Layout layout;
+};
+
+// 归档目录
+class SessionArchive {
+public:
+    explicit SessionArchive(const std::string &directory);
+
+    // 把会话写成新的归档文件，正在计时的时段按 nowNs 截止。
+    // 没有开始过的时段时不写，返回 true；写入失败返回 false
+    bool add(const TimerEngine &engine, int64_t nowNs);
+    static bool write(const std::string &path, const TimerEngine &engine, int64_t nowNs);
+
+    // 映射目录中的所有归档，按会话开始时间排序；无法识别的文件跳过。返回映射的数量
+    int load();
+    const std::vector<ArchivedSession> &sessions() const { return mapped; }
+
+    static const char FILE_SUFFIX[];
+
+private:
+    std::string directory;
+    std::vector<ArchivedSession> mapped;
+};
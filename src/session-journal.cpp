@@ -0,0 +1,681 @@
+#include "session-journal.hpp"
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// 文件头：格式标识和版本
+static const char MAGIC[8] = {'S', 'T', 'J', 'R', 'N', 'L', 0, 1};
+
+// 数据块中每一项的类型
+enum ItemType : uint8_t {
+    SNAPSHOT = 0x53,
+    RECORD_ADDED = 1,
+    RECORD_REMOVED,
+    RECORD_RENAMED,
+    RECORD_TYPE_CHANGED,
+    SEGMENT_ADDED,
+    SEGMENT_REMOVED,
+    SEGMENT_STARTED,
+    SEGMENT_ENDED,
+    SESSION_CLOSED
+};
+
+static std::array<uint32_t, 256> makeCrcTable()
+{
+    std::array<uint32_t, 256> table;
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+static uint32_t crc32(const char *data, size_t size)
+{
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+// 整数按 7 位一组的变长编码，有符号数先做 zigzag 变换，小的数值只占一两个字节
+static void putVarint(std::string &out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+static void putSigned(std::string &out, int64_t value)
+{
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+static void putString(std::string &out, const std::string &text)
+{
+    putVarint(out, text.size());
+    out += text;
+}
+
+// 按顺序读取一个数据块，越界或格式错误后 good 为 false，之后的读取都返回 0
+struct Reader {
+    const char *pos;
+    const char *end;
+    bool good;
+
+    Reader(const char *data, size_t size) : pos(data), end(data + size), good(true) {}
+
+    bool atEnd() const { return pos >= end; }
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; good && shift < 64; shift += 7) {
+            if (pos >= end) {
+                break;
+            }
+            uint8_t byte = static_cast<uint8_t>(*pos++);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        good = false;
+        return 0;
+    }
+
+    int64_t signedValue()
+    {
+        uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    uint32_t id() { return static_cast<uint32_t>(varint()); }
+
+    bool type(SpeakerType *result)
+    {
+        uint64_t value = varint();
+        good = good && value <= static_cast<uint64_t>(SpeakerType::Discussant);
+        *result = static_cast<SpeakerType>(value);
+        return good;
+    }
+
+    std::string text()
+    {
+        uint64_t size = varint();
+        if (!good || size > static_cast<uint64_t>(end - pos)) {
+            good = false;
+            return std::string();
+        }
+        std::string result(pos, static_cast<size_t>(size));
+        pos += size;
+        return result;
+    }
+};
+
+static FILE *openFile(const std::string &path, const char *mode)
+{
+#ifdef _WIN32
+    // 路径是 UTF-8，不能交给按本地代码页解释的 fopen
+    std::wstring wideMode(mode, mode + std::strlen(mode));
+    return _wfopen(std::filesystem::u8path(path).c_str(), wideMode.c_str());
+#else
+    return std::fopen(path.c_str(), mode);
+#endif
+}
+
+static bool syncFile(FILE *file)
+{
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+static bool writeFrameTo(FILE *file, const std::string &payload)
+{
+    // 帧：长度、CRC-32、内容
+    std::string header;
+    putVarint(header, payload.size());
+    uint32_t crc = crc32(payload.data(), payload.size());
+    for (int i = 0; i < 4; ++i) {
+        header += static_cast<char>((crc >> (8 * i)) & 0xff);
+    }
+    return std::fwrite(header.data(), 1, header.size(), file) == header.size() &&
+           std::fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+}
+
+SessionJournal::SessionJournal(const std::string &path)
+    : path(path),
+      file(nullptr),
+      replayed(0),
+      lastNs(0),
+      eventsSinceSnapshot(0),
+      appended(0),
+      committed(0),
+      flushRequested(false),
+      stopping(false),
+      failed(false)
+{
+}
+
+SessionJournal::~SessionJournal()
+{
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        thread.join();
+    }
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+SessionJournal::Status SessionJournal::open(TimerEngine &engine)
+{
+    Status status = recover(engine);
+
+    // 以当前状态开始新的日志：旧文件整体替换为一个快照
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::u8path(path).parent_path(), error);
+    lastNs = engine.wallAnchor().monoNs;
+    eventsSinceSnapshot = 0;
+    if (!replaceFile(encodeSnapshot(engine))) {
+        failed = true;
+        return Status::IoError;
+    }
+
+    thread = std::thread(&SessionJournal::run, this);
+    engine.setJournal(this);
+    return status;
+}
+
+void SessionJournal::close()
+{
+    if (!thread.joinable()) {
+        return;
+    }
+    // 在界面线程上调用，不能用计时线程的编码缓冲区
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(Block{false, std::string(1, static_cast<char>(SESSION_CLOSED))});
+        ++appended;
+    }
+    flush();
+}
+
+void SessionJournal::flush()
+{
+    if (!thread.joinable()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = appended;
+    flushRequested = true;
+    wake.notify_all();
+    done.wait(lock, [this, target]() { return committed >= target; });
+}
+
+void SessionJournal::suspend(TimerEngine &engine)
+{
+    engine.setJournal(nullptr);
+}
+
+void SessionJournal::resume(TimerEngine &engine)
+{
+    if (!thread.joinable()) {
+        return;
+    }
+    // 暂停期间的修改不在日志中，以快照整体替换文件，之后的事件接在快照之后
+    std::string snapshot = encodeSnapshot(engine);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(Block{true, std::move(snapshot)});
+        ++appended;
+    }
+    wake.notify_all();
+    lastNs = engine.wallAnchor().monoNs;
+    eventsSinceSnapshot = 0;
+    engine.setJournal(this);
+}
+
+bool SessionJournal::ok()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return !failed;
+}
+
+void SessionJournal::recordAdded(const TimerEngine &engine, RecordId id, SpeakerType type)
+{
+    event.clear();
+    event += static_cast<char>(RECORD_ADDED);
+    putVarint(event, id);
+    putVarint(event, static_cast<uint64_t>(type));
+    appendEvent(engine, event);
+}
+
+void SessionJournal::recordRemoved(const TimerEngine &engine, RecordId id)
+{
+    event.clear();
+    event += static_cast<char>(RECORD_REMOVED);
+    putVarint(event, id);
+    appendEvent(engine, event);
+}
+
+void SessionJournal::recordRenamed(const TimerEngine &engine, RecordId id, const std::string &name)
+{
+    event.clear();
+    event += static_cast<char>(RECORD_RENAMED);
+    putVarint(event, id);
+    putString(event, name);
+    appendEvent(engine, event);
+}
+
+void SessionJournal::recordTypeChanged(const TimerEngine &engine, RecordId id, SpeakerType type)
+{
+    event.clear();
+    event += static_cast<char>(RECORD_TYPE_CHANGED);
+    putVarint(event, id);
+    putVarint(event, static_cast<uint64_t>(type));
+    appendEvent(engine, event);
+}
+
+void SessionJournal::segmentAdded(const TimerEngine &engine, RecordId recordId, SegmentId id)
+{
+    event.clear();
+    event += static_cast<char>(SEGMENT_ADDED);
+    putVarint(event, recordId);
+    putVarint(event, id);
+    appendEvent(engine, event);
+}
+
+void SessionJournal::segmentRemoved(const TimerEngine &engine, SegmentId id)
+{
+    event.clear();
+    event += static_cast<char>(SEGMENT_REMOVED);
+    putVarint(event, id);
+    appendEvent(engine, event);
+}
+
+void SessionJournal::segmentStarted(const TimerEngine &engine, SegmentId id, int64_t atNs, int64_t latencyNs)
+{
+    event.clear();
+    event += static_cast<char>(SEGMENT_STARTED);
+    putVarint(event, id);
+    encodeTime(event, atNs);
+    putSigned(event, latencyNs);
+    appendEvent(engine, event);
+}
+
+void SessionJournal::segmentEnded(const TimerEngine &engine, SegmentId id, int64_t atNs, int64_t latencyNs)
+{
+    event.clear();
+    event += static_cast<char>(SEGMENT_ENDED);
+    putVarint(event, id);
+    encodeTime(event, atNs);
+    putSigned(event, latencyNs);
+    appendEvent(engine, event);
+}
+
+void SessionJournal::encodeTime(std::string &out, int64_t ns)
+{
+    // 相邻两次操作通常相隔几秒到几分钟，差值只占几个字节
+    putSigned(out, ns - lastNs);
+    lastNs = ns;
+}
+
+void SessionJournal::appendEvent(const TimerEngine &engine, const std::string &data)
+{
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle = pending.empty();
+        if (idle || pending.back().snapshot) {
+            pending.push_back(Block{false, std::string()});
+        }
+        pending.back().data += data;
+        ++appended;
+    }
+    // 写入线程正在等待提交间隔时不用唤醒
+    if (idle) {
+        wake.notify_all();
+    }
+
+    if (++eventsSinceSnapshot >= SNAPSHOT_EVENTS) {
+        std::string snapshot = encodeSnapshot(engine);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(Block{true, std::move(snapshot)});
+            ++appended;
+        }
+        lastNs = engine.wallAnchor().monoNs;
+        eventsSinceSnapshot = 0;
+    }
+}
+
+std::string SessionJournal::encodeSnapshot(const TimerEngine &engine) const
+{
+    // 快照中的时间以锚点的单调读数为基准，恢复时据锚点的墙上时间换算到新的时钟
+    const WallClockAnchor &anchor = engine.wallAnchor();
+    std::string out;
+    out += static_cast<char>(SNAPSHOT);
+    putSigned(out, anchor.monoNs);
+    putSigned(out, anchor.wallMs);
+    putVarint(out, engine.nextRecordId);
+    putVarint(out, engine.nextSegmentId);
+    putVarint(out, engine.records.size());
+    for (RecordId id = engine.firstRecord(); id != NO_ID; id = engine.nextRecord(id)) {
+        const TimerRecord &record = *engine.findRecord(id);
+        putVarint(out, id);
+        putVarint(out, static_cast<uint64_t>(record.type));
+        putString(out, record.name);
+        putVarint(out, record.segments.size());
+        for (SegmentId segmentId : record.segments) {
+            const TimerSegment &segment = *engine.findSegment(segmentId);
+            putVarint(out, segmentId);
+            putVarint(out, (segment.isStarted() ? 1 : 0) | (segment.isEnded() ? 2 : 0));
+            if (segment.isStarted()) {
+                putSigned(out, segment.startNs - anchor.monoNs);
+                putSigned(out, segment.startLatencyNs);
+            }
+            if (segment.isEnded()) {
+                putSigned(out, segment.endNs - segment.startNs);
+                putSigned(out, segment.endLatencyNs);
+            }
+        }
+    }
+    return out;
+}
+
+SessionJournal::Status SessionJournal::recover(TimerEngine &engine)
+{
+    replayed = 0;
+    FILE *in = openFile(path, "rb");
+    if (!in) {
+        return Status::Empty;
+    }
+    std::string data;
+    char buffer[64 * 1024];
+    size_t count;
+    while ((count = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        data.append(buffer, count);
+    }
+    std::fclose(in);
+
+    if (data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return Status::Corrupt;
+    }
+
+    // 先恢复到副本，日志不完整时不影响传入的引擎。
+    // 最低时间是界面设置，不在日志中，沿用 engine 上已有的值
+    TimerEngine restored(engine.wallAnchor());
+    for (SpeakerType type : {SpeakerType::Speaker, SpeakerType::Discussant}) {
+        restored.setMinTimeMinutes(type, engine.minTimeMinutes(type));
+    }
+    const WallClockAnchor &now = engine.wallAnchor();
+    int64_t shiftNs = 0;
+    int64_t timeNs = 0;
+    bool haveSnapshot = false;
+    bool closed = false;
+    bool consistent = true;
+
+    Reader frames(data.data() + sizeof(MAGIC), data.size() - sizeof(MAGIC));
+    while (consistent && !frames.atEnd()) {
+        // 崩溃时写了一半的最后一帧长度或 CRC 对不上，到此为止
+        uint64_t size = frames.varint();
+        if (!frames.good || static_cast<uint64_t>(frames.end - frames.pos) < size + 4) {
+            break;
+        }
+        uint32_t crc = 0;
+        for (int i = 0; i < 4; ++i) {
+            crc |= static_cast<uint32_t>(static_cast<uint8_t>(*frames.pos++)) << (8 * i);
+        }
+        const char *payload = frames.pos;
+        frames.pos += size;
+        if (crc32(payload, static_cast<size_t>(size)) != crc) {
+            break;
+        }
+
+        Reader r(payload, static_cast<size_t>(size));
+        if (!haveSnapshot) {
+            if (r.varint() != SNAPSHOT) {
+                return Status::Corrupt;
+            }
+            WallClockAnchor then = now;
+            then.monoNs = r.signedValue();
+            then.wallMs = r.signedValue();
+            // 上次会话的时刻 t 在新时钟上为 t + shiftNs，时长不变
+            shiftNs = (then.wallMs - now.wallMs) * NS_PER_MS + (now.monoNs - then.monoNs);
+            timeNs = then.monoNs;
+
+            restored.nextRecordId = r.id();
+            restored.nextSegmentId = r.id();
+            uint64_t recordCount = r.varint();
+            for (uint64_t i = 0; r.good && i < recordCount; ++i) {
+                RecordId id = r.id();
+                TimerRecord &record = restored.records[id];
+                record.id = id;
+                r.type(&record.type);
+                record.name = r.text();
+                record.prev = restored.tail;
+                if (restored.tail != NO_ID) {
+                    restored.records[restored.tail].next = id;
+                } else {
+                    restored.head = id;
+                }
+                restored.tail = id;
+
+                uint64_t segmentCount = r.varint();
+                for (uint64_t k = 0; r.good && k < segmentCount; ++k) {
+                    SegmentId segmentId = r.id();
+                    TimerSegment &segment = restored.segments[segmentId];
+                    segment.id = segmentId;
+                    segment.recordId = id;
+                    uint64_t flags = r.varint();
+                    if (flags & 1) {
+                        segment.startNs = then.monoNs + r.signedValue() + shiftNs;
+                        segment.startLatencyNs = r.signedValue();
+                    }
+                    if (flags & 2) {
+                        segment.endNs = segment.startNs + r.signedValue();
+                        segment.endLatencyNs = r.signedValue();
+                        record.closedNs += segment.endNs - segment.startNs;
+                    } else if (flags & 1) {
+                        segment.isRunning = true;
+                        record.runningSegment = segmentId;
+                        record.runningStartNs = segment.startNs;
+                        restored.running.push_back(id);
+                    }
+                    record.segments.push_back(segmentId);
+                }
+            }
+            if (!r.good || !r.atEnd()) {
+                return Status::Corrupt;
+            }
+            for (RecordId id : restored.running) {
+                TimerRecord &record = restored.records[id];
+                restored.scheduleDeadline(record, record.runningStartNs);
+            }
+            haveSnapshot = true;
+            continue;
+        }
+
+        // 按原来的顺序重放事件；ID 的分配是确定的，重放得到的 ID 必须与记录的一致
+        while (consistent && r.good && !r.atEnd()) {
+            uint64_t type = r.varint();
+            switch (type) {
+            case RECORD_ADDED: {
+                RecordId id = r.id();
+                SpeakerType speakerType;
+                consistent = r.type(&speakerType) && restored.addRecord(speakerType) == id;
+                break;
+            }
+            case RECORD_REMOVED: {
+                RecordId id = r.id();
+                consistent = r.good && restored.findRecord(id);
+                if (consistent) {
+                    restored.removeRecord(id);
+                }
+                break;
+            }
+            case RECORD_RENAMED: {
+                RecordId id = r.id();
+                std::string name = r.text();
+                consistent = r.good && restored.findRecord(id);
+                if (consistent) {
+                    restored.setRecordName(id, name);
+                }
+                break;
+            }
+            case RECORD_TYPE_CHANGED: {
+                RecordId id = r.id();
+                SpeakerType speakerType;
+                consistent = r.type(&speakerType) && restored.findRecord(id);
+                if (consistent) {
+                    restored.setRecordType(id, speakerType);
+                }
+                break;
+            }
+            case SEGMENT_ADDED: {
+                RecordId recordId = r.id();
+                SegmentId id = r.id();
+                SegmentId added = NO_ID;
+                consistent = r.good && restored.addSegment(recordId, &added) == TimerEngine::Result::Ok &&
+                             added == id;
+                break;
+            }
+            case SEGMENT_REMOVED: {
+                SegmentId id = r.id();
+                consistent = r.good && restored.findSegment(id);
+                if (consistent) {
+                    restored.removeSegment(id);
+                }
+                break;
+            }
+            case SEGMENT_STARTED:
+            case SEGMENT_ENDED: {
+                SegmentId id = r.id();
+                timeNs += r.signedValue();
+                int64_t latencyNs = r.signedValue();
+                TimerEngine::Result result = type == SEGMENT_STARTED
+                    ? restored.startSegment(id, timeNs + shiftNs, latencyNs)
+                    : restored.endSegment(id, timeNs + shiftNs, latencyNs);
+                consistent = r.good && result == TimerEngine::Result::Ok;
+                break;
+            }
+            case SESSION_CLOSED:
+                closed = true;
+                break;
+            default:
+                consistent = false;
+            }
+            if (consistent && r.good) {
+                ++replayed;
+            }
+        }
+    }
+
+    if (!haveSnapshot) {
+        return Status::Corrupt;
+    }
+    if (closed) {
+        replayed = 0;
+        return Status::Empty;
+    }
+    engine = restored;
+    return Status::Recovered;
+}
+
+bool SessionJournal::replaceFile(const std::string &snapshot)
+{
+    // 新文件写完并落盘后才替换旧文件，任何时刻崩溃都留下一个完整的日志
+    std::string temp = path + ".tmp";
+    FILE *out = openFile(temp, "wb");
+    if (!out) {
+        return false;
+    }
+    bool good = std::fwrite(MAGIC, 1, sizeof(MAGIC), out) == sizeof(MAGIC) && writeFrameTo(out, snapshot) &&
+                syncFile(out);
+    good = std::fclose(out) == 0 && good;
+    if (!good) {
+        return false;
+    }
+
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    std::error_code error;
+    std::filesystem::rename(std::filesystem::u8path(temp), std::filesystem::u8path(path), error);
+    if (error) {
+        return false;
+    }
+    file = openFile(path, "ab");
+    return file != nullptr;
+}
+
+bool SessionJournal::writeFrame(const std::string &payload)
+{
+    return file && writeFrameTo(file, payload);
+}
+
+void SessionJournal::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this]() { return stopping || flushRequested || !pending.empty(); });
+        if (pending.empty()) {
+            if (stopping) {
+                break;
+            }
+            flushRequested = false;
+            done.notify_all();
+            continue;
+        }
+
+        // 等一个提交间隔，这期间追加的事件一起写入，只 fsync 一次
+        if (!stopping && !flushRequested) {
+            wake.wait_for(lock, std::chrono::milliseconds(COMMIT_INTERVAL_MS),
+                          [this]() { return stopping || flushRequested; });
+        }
+        std::deque<Block> blocks;
+        blocks.swap(pending);
+        uint64_t target = appended;
+        flushRequested = false;
+        lock.unlock();
+
+        bool good = true;
+        for (const Block &block : blocks) {
+            if (!(block.snapshot ? replaceFile(block.data) : writeFrame(block.data))) {
+                good = false;
+            }
+        }
+        good = file && syncFile(file) && good;
+
+        lock.lock();
+        failed = failed || !good;
+        committed = target;
+        done.notify_all();
+    }
+}
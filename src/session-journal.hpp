@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "timer-engine.hpp"
+
+// 会话日志：计时模型的每次修改（增删记录和时段、改名、改类型、开始/结束）
+// 以紧凑的二进制事件追加到文件，OBS 崩溃后可以从中重建整场会话。
+//
+// 文件由一个快照和其后的事件组成。事件在计时线程上编码，写入由单独的线程完成：
+// 一个提交间隔内的事件合并为一帧，只写一次、fsync 一次（组提交），计时线程不等待磁盘。
+// 每帧带长度和 CRC，崩溃时写了一半的最后一帧在恢复时丢弃。
+// 事件累积到一定数量后写入新的快照，整个文件原子地替换为快照，恢复时间因此有上限。
+//
+// 最低时间是界面设置，不属于会话，不写入日志。
+class SessionJournal {
+public:
+    enum class Status {
+        Empty,      // 没有日志，或者上次会话已正常结束
+        Recovered,  // 从日志恢复了上次的会话
+        Corrupt,    // 日志无法读取，从空会话开始
+        IoError     // 无法创建日志文件，之后的修改不会被记录
+    };
+
+    explicit SessionJournal(const std::string &path);
+    // 写出所有已追加的事件后停止写入线程
+    ~SessionJournal();
+
+    SessionJournal(const SessionJournal &) = delete;
+    SessionJournal &operator=(const SessionJournal &) = delete;
+
+    // 在计时线程上调用一次：把上次崩溃时的会话恢复到 engine（应为空），
+    // 以恢复后的状态开始新的日志，并把日志挂到 engine 上。
+    // 上次会话的时间按墙上时间换算到 engine 的时钟，时段的时长保持不变
+    Status open(TimerEngine &engine);
+    // 写入会话结束标记并等待写盘，下次打开时不再恢复
+    void close();
+    // 等待已追加的事件写入磁盘
+    void flush();
+    // 在计时线程上调用：暂停记录，之后对 engine 的修改不写入日志，崩溃时恢复暂停前的会话
+    void suspend(TimerEngine &engine);
+    // 在计时线程上调用：以 engine 的当前状态写入新的快照，继续记录
+    void resume(TimerEngine &engine);
+
+    // 由 TimerEngine 在修改完成后调用
+    void recordAdded(const TimerEngine &engine, RecordId id, SpeakerType type);
+    void recordRemoved(const TimerEngine &engine, RecordId id);
+    void recordRenamed(const TimerEngine &engine, RecordId id, const std::string &name);
+    void recordTypeChanged(const TimerEngine &engine, RecordId id, SpeakerType type);
+    void segmentAdded(const TimerEngine &engine, RecordId recordId, SegmentId id);
+    void segmentRemoved(const TimerEngine &engine, SegmentId id);
+    void segmentStarted(const TimerEngine &engine, SegmentId id, int64_t atNs, int64_t latencyNs);
+    void segmentEnded(const TimerEngine &engine, SegmentId id, int64_t atNs, int64_t latencyNs);
+
+    // 上次 open() 重放的事件数
+    int recoveredEvents() const { return replayed; }
+    // 写入是否一直成功
+    bool ok();
+
+    // 两次快照之间最多的事件数
+    static constexpr int SNAPSHOT_EVENTS = 4096;
+    // 组提交的间隔
+    static constexpr int COMMIT_INTERVAL_MS = 50;
+
+private:
+    // 写入线程按顺序处理的数据块：一段事件，或替换整个文件的快照
+    struct Block {
+        bool snapshot;
+        std::string data;
+    };
+
+    Status recover(TimerEngine &engine);
+    std::string encodeSnapshot(const TimerEngine &engine) const;
+    void appendEvent(const TimerEngine &engine, const std::string &event);
+    void encodeTime(std::string &out, int64_t ns);
+    bool replaceFile(const std::string &snapshot);
+    bool writeFrame(const std::string &payload);
+    void run();
+
+    const std::string path;
+    FILE *file;
+    int replayed;
+
+    // 以下只在计时线程上访问
+    int64_t lastNs;       // 事件中的时间记为与上一个时间的差
+    int eventsSinceSnapshot;
+    std::string event;    // 复用的编码缓冲区
+
+    std::mutex mutex;
+    std::condition_variable wake;  // 有新数据、需要立即写盘或需要退出
+    std::condition_variable done;  // 一次提交完成
+    std::deque<Block> pending;
+    uint64_t appended;    // 追加的次数
+    uint64_t committed;   // 已写盘的追加次数
+    bool flushRequested;
+    bool stopping;
+    bool failed;
+    std::thread thread;
+};
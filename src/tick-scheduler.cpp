@@ -0,0 +1,118 @@
+#include "tick-scheduler.hpp"
+#include "latency-histogram.hpp"
+#include "timer-service.hpp"
+#include <QTimer>
+#include <algorithm>
+
+// 在整秒之后稍晚一点触发，保证读到的时间已经跨过整秒
+static const int TICK_SLACK_MS = 2;
+
+static int64_t floorMod(int64_t value, int64_t divisor)
+{
+    int64_t remainder = value % divisor;
+    return remainder < 0 ? remainder + divisor : remainder;
+}
+
+TickScheduler::TickScheduler(TimerService &service, QObject *parent)
+    : QObject(parent),
+      service(service),
+      running(false),
+      visible(false),
+      dueNs(TIMER_NO_TIME),
+      lastTickNs(TIMER_NO_TIME),
+      lateness(nullptr)
+{
+    timer = new QTimer(this);
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &TickScheduler::onTimeout);
+}
+
+void TickScheduler::setRunning(bool value)
+{
+    // 仍在计时时也要重新安排：新开始的时段有自己的整秒边界。
+    // 已安排的刷新更早时保留，不会错过其他时段即将到来的边界
+    running = value;
+    reschedule(true);
+}
+
+void TickScheduler::setVisible(bool value)
+{
+    if (visible == value) {
+        return;
+    }
+    visible = value;
+
+    // 挂起期间没有刷新，重新可见时先补一次
+    if (isActive()) {
+        Q_EMIT tick();
+    }
+    reschedule(false);
+}
+
+// 时段显示 nowNs - startNs，累计显示 closedNs + nowNs - startNs，两者各在自己的起点加整秒时变化
+template <typename Fn>
+static void forEachBoundary(const std::vector<RunningTime> &running, int64_t nowNs, Fn fn)
+{
+    for (const RunningTime &entry : running) {
+        for (int64_t originNs : {entry.startNs, entry.startNs - entry.closedNs}) {
+            fn(nowNs + NS_PER_SEC - floorMod(nowNs - originNs, NS_PER_SEC));
+        }
+    }
+}
+
+int64_t TickScheduler::nextTickNs(const std::vector<RunningTime> &running, int64_t nowNs)
+{
+    if (running.empty()) {
+        return TIMER_NO_TIME;
+    }
+    int64_t firstNs = INT64_MAX;
+    forEachBoundary(running, nowNs, [&firstNs](int64_t boundaryNs) { firstNs = std::min(firstNs, boundaryNs); });
+    // 把窗口内的边界合并到一次刷新，刷新时刻取其中最后一个，窗口内的边界都已跨过
+    int64_t windowEndNs = firstNs + COALESCE_MS * NS_PER_MS;
+    int64_t tickNs = firstNs;
+    forEachBoundary(running, nowNs, [windowEndNs, &tickNs](int64_t boundaryNs) {
+        if (boundaryNs <= windowEndNs) {
+            tickNs = std::max(tickNs, boundaryNs);
+        }
+    });
+    return tickNs;
+}
+
+void TickScheduler::reschedule(bool keepEarlier)
+{
+    if (!isActive()) {
+        timer->stop();
+        return;
+    }
+
+    int64_t steadyNs = timerNowNs();
+    TimerClock &clock = service.timerClock();
+    int64_t boundaryNs = nextTickNs(service.snapshot().running, clock.nowNs());
+    // 边界是计时时钟的读数，换算为单调时钟；暂停的虚拟时钟不会自己到达，每秒刷新一次
+    int64_t targetNs = boundaryNs == TIMER_NO_TIME ? TIMER_NO_TIME : clock.steadyNsAt(boundaryNs);
+    if (targetNs == TIMER_NO_TIME) {
+        targetNs = steadyNs + NS_PER_SEC;
+    }
+    if (lastTickNs != TIMER_NO_TIME) {
+        targetNs = std::max(targetNs, lastTickNs + MIN_INTERVAL_MS * NS_PER_MS);
+    }
+    targetNs = std::max(targetNs, steadyNs);
+
+    if (keepEarlier && timer->isActive() && dueNs <= targetNs) {
+        return;
+    }
+    dueNs = targetNs;
+    int delayMs = static_cast<int>((dueNs - steadyNs + NS_PER_MS - 1) / NS_PER_MS) + TICK_SLACK_MS;
+    timer->start(delayMs);
+}
+
+void TickScheduler::onTimeout()
+{
+    lastTickNs = timerNowNs();
+    if (lateness) {
+        lateness->record(lastTickNs - dueNs);
+    }
+    Q_EMIT tick();
+    reschedule(false);
+}
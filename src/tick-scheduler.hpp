@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QObject>
+#include <vector>
+#include "timer-clock.hpp"
+
+class QTimer;
+class LatencyHistogram;
+class TimerService;
+struct RunningTime;
+
+// 计时窗口的刷新调度器：
+// - 在正在计时的时段或累计时间跨过下一个整秒时触发，显示的秒数跟随真实的整秒边界
+//   （开始时间 + k 秒）变化，而不是落后最多一秒；
+// - 各记录的边界各不相同，COALESCE_MS 之内的边界合并为一次刷新，两次刷新至少间隔
+//   MIN_INTERVAL_MS：无论多少记录在计时，每秒最多刷新 1000 / MIN_INTERVAL_MS 次，
+//   每个边界最多晚 COALESCE_MS 显示；
+// - 没有正在计时的时段时完全停止；
+// - 窗口不可见时挂起，重新可见时立即补一次刷新。
+class TickScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TickScheduler(TimerService &service, QObject *parent = nullptr);
+
+    // 开始、结束或删除时段后调用，按新的计时时段重新安排
+    void setRunning(bool running);
+    void setVisible(bool visible);
+    bool isActive() const { return running && visible; }
+    // 记录每次定时刷新比预定的整秒晚了多少
+    void setLatenessHistogram(LatencyHistogram *histogram) { lateness = histogram; }
+
+    // nowNs 之后的下一次刷新时刻（计时所用时钟）：最早的边界之后 COALESCE_MS 之内的最后一个边界。
+    // 没有正在计时的时段时为 TIMER_NO_TIME
+    static int64_t nextTickNs(const std::vector<RunningTime> &running, int64_t nowNs);
+
+    static const int COALESCE_MS = 150;
+    static const int MIN_INTERVAL_MS = 100;
+
+Q_SIGNALS:
+    void tick();
+
+private:
+    void reschedule(bool keepEarlier);
+    void onTimeout();
+
+    TimerService &service;
+    QTimer *timer;
+    bool running;
+    bool visible;
+    int64_t dueNs;       // 下一次刷新预定的时刻（单调时钟）
+    int64_t lastTickNs;  // 上一次定时刷新的时刻（单调时钟）
+    LatencyHistogram *lateness;
+};
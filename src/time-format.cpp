@@ -0,0 +1,25 @@
+#include "time-format.hpp"
+#include <QDateTime>
+
+QString formatDuration(int64_t ns)
+{
+    int64_t secs = ns > 0 ? ns / NS_PER_SEC : 0;
+    return QString("%1:%2")
+        .arg(secs / 60, 2, 10, QChar('0'))
+        .arg(secs % 60, 2, 10, QChar('0'));
+}
+
+QString formatClockTime(const WallClockAnchor &anchor, int64_t ns)
+{
+    return QDateTime::fromMSecsSinceEpoch(anchor.toWallMs(ns)).toString("HH:mm:ss");
+}
+
+QString formatLatency(int64_t ns)
+{
+    return QString("点击延迟: %1 ms").arg(ns / NS_PER_MS);
+}
+
+QString speakerTypeName(SpeakerType type)
+{
+    return type == SpeakerType::Speaker ? "讲者" : "讨论嘉宾";
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QString>
+#include "timer-record.hpp"
+
+// 界面和导出共用的格式化
+
+// mm:ss，分钟不按小时折回，超过一小时显示为 75:03 这样的形式
+QString formatDuration(int64_t ns);
+
+// HH:mm:ss，单调时钟读数按锚点换算为墙上时间
+QString formatClockTime(const WallClockAnchor &anchor, int64_t ns);
+
+QString formatLatency(int64_t ns);
+
+// 与类型下拉框中的文字一致
+QString speakerTypeName(SpeakerType type);
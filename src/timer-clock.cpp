@@ -0,0 +1,72 @@
+#include "timer-clock.hpp"
+#include <cmath>
+
+TimerClock &steadyClock()
+{
+    static SteadyClock clock;
+    return clock;
+}
+
+VirtualClock::VirtualClock(double rate, int64_t startNs)
+    : baseNs(startNs),
+      baseSteadyNs(timerNowNs()),
+      speed(rate > 0.0 ? rate : 0.0)
+{
+}
+
+int64_t VirtualClock::nowNs() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return readingAt(timerNowNs());
+}
+
+int64_t VirtualClock::steadyNsAt(int64_t clockNs) const
+{
+    int64_t steadyNs = timerNowNs();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (readingAt(steadyNs) >= clockNs) {
+        return steadyNs;
+    }
+    if (speed == 0.0) {
+        return TIMER_NO_TIME;
+    }
+    // 向上取整，保证醒来时读数已经到达
+    return baseSteadyNs + static_cast<int64_t>(std::ceil(static_cast<double>(clockNs - baseNs) / speed));
+}
+
+int64_t VirtualClock::fromSteadyNs(int64_t steadyNs) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return readingAt(steadyNs);
+}
+
+double VirtualClock::rate() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return speed;
+}
+
+void VirtualClock::setRate(double rate)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    rebase(timerNowNs());
+    speed = rate > 0.0 ? rate : 0.0;
+}
+
+void VirtualClock::advance(int64_t ns)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    rebase(timerNowNs());
+    baseNs += ns;
+}
+
+void VirtualClock::rebase(int64_t steadyNs)
+{
+    baseNs = readingAt(steadyNs);
+    baseSteadyNs = steadyNs;
+}
+
+int64_t VirtualClock::readingAt(int64_t steadyNs) const
+{
+    return baseNs + static_cast<int64_t>(static_cast<double>(steadyNs - baseSteadyNs) * speed);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+const int64_t NS_PER_MS = 1000000LL;
+const int64_t NS_PER_SEC = 1000000000LL;
+const int64_t NS_PER_MIN = 60LL * NS_PER_SEC;
+
+// 未记录的时间点
+const int64_t TIMER_NO_TIME = INT64_MIN;
+
+// 单调时钟读数（纳秒）。所有时长都由两次读数直接相减得到，
+// 不受跨午夜、系统改时或夏令时的影响
+inline int64_t timerNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 墙上时间锚点：同一时刻的单调读数与系统时间，只用于显示和导出
+struct WallClockAnchor {
+    int64_t monoNs;
+    int64_t wallMs;  // 自 Unix 纪元起的毫秒数
+
+    WallClockAnchor() : WallClockAnchor(timerNowNs()) {}
+
+    // monoNs 为计时所用时钟（见 TimerClock）此刻的读数
+    explicit WallClockAnchor(int64_t monoNs)
+        : monoNs(monoNs),
+          wallMs(std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch()).count()) {}
+
+    int64_t toWallMs(int64_t ns) const
+    {
+        return wallMs + (ns - monoNs) / NS_PER_MS;
+    }
+};
+
+// 计时逻辑读取的时钟。计时线程和界面都通过它取当前时刻，
+// 默认是单调时钟；换成 VirtualClock 可以加速或手动推进，快速、可重复地回放整场活动
+class TimerClock {
+public:
+    virtual ~TimerClock() {}
+
+    virtual int64_t nowNs() const = 0;
+    // 读数到达 clockNs 时单调时钟（timerNowNs）的读数，用于计时线程等待截止时间；
+    // 暂停的时钟不会自己到达，返回 TIMER_NO_TIME
+    virtual int64_t steadyNsAt(int64_t clockNs) const = 0;
+    // 单调时钟的读数换算为这个时钟的读数，用于输入事件的时间戳
+    virtual int64_t fromSteadyNs(int64_t steadyNs) const = 0;
+};
+
+class SteadyClock : public TimerClock {
+public:
+    int64_t nowNs() const override { return timerNowNs(); }
+    int64_t steadyNsAt(int64_t clockNs) const override { return clockNs; }
+    int64_t fromSteadyNs(int64_t steadyNs) const override { return steadyNs; }
+};
+
+// 全局共享的单调时钟
+TimerClock &steadyClock();
+
+// 虚拟时钟：按 rate 倍速随真实时间前进（例如 1000 倍速时一天约 86 秒），
+// rate 为 0 时暂停，只随 advance() 前进。任何线程都可以读取和调整；
+// 调整后要调用 TimerService::clockChanged()，让计时线程按新的速度重新等待
+class VirtualClock : public TimerClock {
+public:
+    explicit VirtualClock(double rate = 1.0, int64_t startNs = 0);
+
+    int64_t nowNs() const override;
+    int64_t steadyNsAt(int64_t clockNs) const override;
+    int64_t fromSteadyNs(int64_t steadyNs) const override;
+
+    double rate() const;
+    void setRate(double rate);
+    void advance(int64_t ns);
+
+private:
+    // 以当前时刻为新的基准，之后按新的速度前进
+    void rebase(int64_t steadyNs);
+    int64_t readingAt(int64_t steadyNs) const;
+
+    mutable std::mutex mutex;
+    int64_t baseNs;        // baseSteadyNs 时刻的读数
+    int64_t baseSteadyNs;
+    double speed;
+};
@@ -1,4 +1,16 @@
 #include "timer-dock.hpp"
+#include "tick-scheduler.hpp"
+#include "click-stamp.hpp"
+#include "record-list-model.hpp"
+#include "record-list-view.hpp"
+#include "record-row-delegate.hpp"
+#include "time-format.hpp"
+#include "export-job.hpp"
+#include "load-generator.hpp"
+#include "session-archive.hpp"
+#include "session-journal.hpp"
+#include "profile-scope.hpp"
+#include <util/base.h>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QComboBox>
@@ -8,22 +20,28 @@
 #include <QSpinBox>
 #include <QDateTime>
 #include <QFile>
+#include <QSaveFile>
+#include <QProgressBar>
 #include <QTextStream>
 #include <QMessageBox>
 #include <QDebug>
 #include <QSpacerItem>
 #include <QSizePolicy>
-#include <QScrollArea>
 #include <QClipboard>
 #include <QApplication>
 #include <QPropertyAnimation>
 #include <QStackedWidget>
 #include <QFrame>
 #include <QFileDialog>
+#include <QMenu>
+#include <QShortcut>
 #include <QStandardPaths>
 #include <QStringConverter>
 #include <QScreen>
 #include <QGuiApplication>
+#include <QStyle>
+#include <QEvent>
+#include <tuple>
 
 const int TimerDock::DEFAULT_SPEAKER_TIMES[] = {10, 15, 20, 30, 40, 60};
 const int TimerDock::DEFAULT_DISCUSSANT_TIMES[] = {5, 10, 15, 20, 30};
@@ -44,12 +62,46 @@ TimerDock::TimerDock(QWidget *parent)
     
     // 初始时隐藏窗口
     hide();
-    
-    setupUI();
 
-    updateTimer = new QTimer(this);
-    connect(updateTimer, &QTimer::timeout, this, &TimerDock::updateAllTimes);
-    updateTimer->start(1000);
+    // 界面和计时线程在第一次显示时才创建，加载插件时只注册一个空的停靠窗口。
+    // 连接可见性变化信号
+    connect(this, &QDockWidget::visibilityChanged, this, &TimerDock::onVisibilityChanged);
+}
+
+void TimerDock::showEvent(QShowEvent *event)
+{
+    ensureContent();
+    QDockWidget::showEvent(event);
+}
+
+void TimerDock::ensureContent()
+{
+    if (mainWidget) {
+        return;
+    }
+    int64_t startNs = timerNowNs();
+
+    // 调试和回放用：环境变量 SPEECH_TIMER_CLOCK_RATE 设为倍速（如 1000）时，计时使用加速的虚拟时钟
+    bool rateOk = false;
+    double clockRate = qEnvironmentVariable("SPEECH_TIMER_CLOCK_RATE").toDouble(&rateOk);
+    if (rateOk && clockRate > 0.0 && clockRate != 1.0) {
+        virtualClock = std::make_unique<VirtualClock>(clockRate, timerNowNs());
+        blog(LOG_INFO, "[obs-speech-timer] Using a virtual clock at %.1fx", clockRate);
+    }
+    service = std::make_unique<TimerService>(virtualClock ? *virtualClock : steadyClock());
+
+    // 刷新是每秒一次的根作用域，分析器据此统计超时的次数
+    profile_register_root(ProfileName::UPDATE_ALL_TIMES, static_cast<uint64_t>(NS_PER_SEC));
+
+    // 刷新只在有时段计时且窗口可见时进行，并对齐到各时段自己的整秒
+    tickScheduler = new TickScheduler(*service, this);
+    connect(tickScheduler, &TickScheduler::tick, this, &TimerDock::updateAllTimes);
+    tickScheduler->setLatenessHistogram(&timingStats.tickLateness);
+
+    // 开始/结束时间取自点击事件本身的时间戳
+    clickStamper = new ClickStamper(service->timerClock(), this);
+
+    setupUI();
 
     // 初始化错误提示相关组件
     errorLabel = new QLabel(this);
@@ -63,13 +115,25 @@ TimerDock::TimerDock(QWidget *parent)
     errorTimer = new QTimer(this);
     errorTimer->setSingleShot(true);
     connect(errorTimer, &QTimer::timeout, this, &TimerDock::hideErrorMessage);
-    
-    // 连接可见性变化信号
-    connect(this, &QDockWidget::visibilityChanged, this, &TimerDock::onVisibilityChanged);
+
+    // 第一次显示时 visibilityChanged 先于 showEvent 发出，那时还没有界面，
+    // 刷新的可见状态要在这里补上，否则恢复的计时不会刷新
+    tickScheduler->setVisible(isVisible());
+
+    blog(LOG_INFO, "[obs-speech-timer] Dock content created in %.2f ms",
+         static_cast<double>(timerNowNs() - startNs) / NS_PER_MS);
 }
 
 void TimerDock::onVisibilityChanged(bool visible)
 {
+    // 还没有显示过时没有界面
+    if (!mainWidget) {
+        return;
+    }
+
+    // 隐藏（包括被其他标签页遮住）时挂起刷新
+    tickScheduler->setVisible(visible);
+
     if (visible) {
         // 如果窗口变为可见，且是浮动状态，则移动到合适的位置
         if (isFloating()) {
@@ -85,28 +149,21 @@ void TimerDock::onVisibilityChanged(bool visible)
 
 TimerDock::~TimerDock()
 {
-    updateTimer->stop();
-    for (int i = 0; i < records.size(); ++i) {
-        removeRecordWidgets(i);
+    archiveSession();
+    // 正常关闭时标记会话已结束，下次启动不再恢复
+    if (journal) {
+        journal->close();
     }
 }
 
 void TimerDock::setupUI()
 {
     // Create and set the main widget
-    QWidget *mainWidget = new QWidget(this);
+    mainWidget = new QWidget(this);
     QVBoxLayout *mainLayout = new QVBoxLayout(mainWidget);
     mainLayout->setContentsMargins(10, 10, 10, 10);
     mainLayout->setSpacing(10);
 
-    // Create scroll area
-    QScrollArea *scrollArea = new QScrollArea(mainWidget);
-    scrollArea->setWidgetResizable(true);
-    QWidget *scrollWidget = new QWidget(scrollArea);
-    recordsLayout = new QVBoxLayout(scrollWidget);
-    recordsLayout->setContentsMargins(6, 6, 6, 6);
-    recordsLayout->setSpacing(6);
-    
     // Top controls group
     auto topGroup = new QWidget();
     auto topLayout = new QHBoxLayout(topGroup);
@@ -136,7 +193,7 @@ void TimerDock::setupUI()
     }
     if (defaultSpeakerIndex != -1) {
         speakerMinTimeCombo->setCurrentIndex(defaultSpeakerIndex);
-        customMinTimes[0] = 30;
+        setMinTimeMinutes(SpeakerType::Speaker, 30);
     }
 
     // Add spinbox for custom speaker time
@@ -172,7 +229,7 @@ void TimerDock::setupUI()
     }
     if (defaultDiscussantIndex != -1) {
         discussantMinTimeCombo->setCurrentIndex(defaultDiscussantIndex);
-        customMinTimes[1] = 10;
+        setMinTimeMinutes(SpeakerType::Discussant, 10);
     }
 
     // Add spinbox for custom discussant time
@@ -190,28 +247,20 @@ void TimerDock::setupUI()
                 if (value == -1) {
                     // Show spinbox for custom time
                     speakerCustomTime->show();
-                    speakerCustomTime->setValue(customMinTimes[0]);
+                    speakerCustomTime->setValue(minTimeMinutes(SpeakerType::Speaker));
                 } else {
                     speakerCustomTime->hide();
-                    customMinTimes[0] = value;
+                    setMinTimeMinutes(SpeakerType::Speaker, value);
                 }
                 // 更新所有讲者类型的记录
-                for (int i = 0; i < records.size(); ++i) {
-                    if (records[i].record.type == SpeakerType::Speaker) {
-                        updateTotalTime(i);
-                    }
-                }
+                updateRecordsOfType(SpeakerType::Speaker);
             });
     
     connect(speakerCustomTime, QOverload<int>::of(&QSpinBox::valueChanged),
             [this](int value) {
-                customMinTimes[0] = value;
+                setMinTimeMinutes(SpeakerType::Speaker, value);
                 // 更新所有讲者类型的记录
-                for (int i = 0; i < records.size(); ++i) {
-                    if (records[i].record.type == SpeakerType::Speaker) {
-                        updateTotalTime(i);
-                    }
-                }
+                updateRecordsOfType(SpeakerType::Speaker);
             });
 
     // Connect signals for discussant time
@@ -221,35 +270,88 @@ void TimerDock::setupUI()
                 if (value == -1) {
                     // Show spinbox for custom time
                     discussantCustomTime->show();
-                    discussantCustomTime->setValue(customMinTimes[1]);
+                    discussantCustomTime->setValue(minTimeMinutes(SpeakerType::Discussant));
                 } else {
                     discussantCustomTime->hide();
-                    customMinTimes[1] = value;
+                    setMinTimeMinutes(SpeakerType::Discussant, value);
                 }
                 // 更新所有讨论嘉宾类型的记录
-                for (int i = 0; i < records.size(); ++i) {
-                    if (records[i].record.type == SpeakerType::Discussant) {
-                        updateTotalTime(i);
-                    }
-                }
+                updateRecordsOfType(SpeakerType::Discussant);
             });
     
     connect(discussantCustomTime, QOverload<int>::of(&QSpinBox::valueChanged),
             [this](int value) {
-                customMinTimes[1] = value;
+                setMinTimeMinutes(SpeakerType::Discussant, value);
                 // 更新所有讨论嘉宾类型的记录
-                for (int i = 0; i < records.size(); ++i) {
-                    if (records[i].record.type == SpeakerType::Discussant) {
-                        updateTotalTime(i);
-                    }
-                }
+                updateRecordsOfType(SpeakerType::Discussant);
             });
 
     topLayout->addStretch();
-    recordsLayout->addWidget(topGroup);
-
-    // Add a stretching spacer
-    recordsLayout->addStretch();
+    mainLayout->addWidget(topGroup);
+
+    // 记录列表：只为可见的行创建控件
+    recordModel = new RecordListModel(this);
+    rowDelegate = new RecordRowDelegate(clickStamper, service->wallAnchor(), this);
+    recordView = new RecordListView(mainWidget);
+    recordView->setDelegate(rowDelegate);
+    // 记录很多、滚动频繁时可以用环境变量 SPEECH_TIMER_ROW_POOL 加大对象池，0 表示不保留空闲控件
+    bool poolOk = false;
+    int poolSize = qEnvironmentVariableIntValue("SPEECH_TIMER_ROW_POOL", &poolOk);
+    if (!poolOk || poolSize < 0) {
+        poolSize = DEFAULT_ROW_POOL_SIZE;
+    }
+    recordView->setPoolSize(qMin(poolSize, static_cast<int>(MAX_ROW_POOL_SIZE)));
+    recordView->setModel(recordModel);
+    mainLayout->addWidget(recordView, 1);
+
+    connect(rowDelegate, &RecordRowDelegate::addSegmentClicked, this, &TimerDock::onAddSegment);
+    connect(rowDelegate, &RecordRowDelegate::deleteRecordClicked, this, &TimerDock::onDeleteRecord);
+    connect(rowDelegate, &RecordRowDelegate::expandClicked, this,
+            [this](RecordId recordId) { setRecordExpanded(recordId, !recordModel->isExpanded(recordId)); });
+    connect(rowDelegate, &RecordRowDelegate::typeChanged, this, &TimerDock::onRecordTypeChanged);
+    connect(rowDelegate, &RecordRowDelegate::nameChanged, this, &TimerDock::onRecordNameChanged);
+    connect(rowDelegate, &RecordRowDelegate::startClicked, this, &TimerDock::onStartSegment);
+    connect(rowDelegate, &RecordRowDelegate::endClicked, this, &TimerDock::onEndSegment);
+    connect(rowDelegate, &RecordRowDelegate::deleteSegmentClicked, this, &TimerDock::onDeleteSegment);
+
+    // 压力测试通过与按钮相同的槽操作记录
+    LoadGenerator::Actions loadActions;
+    loadActions.addRecord = [this]() { onAddRecord(); };
+    loadActions.deleteRecord = [this](RecordId recordId) { onDeleteRecord(recordId); };
+    loadActions.addSegment = [this](RecordId recordId) { onAddSegment(recordId); };
+    loadActions.deleteSegment = [this](RecordId recordId, SegmentId segmentId) {
+        onDeleteSegment(recordId, segmentId);
+    };
+    loadActions.startSegment = [this](RecordId recordId, SegmentId segmentId, const ClickStamper::Stamp &stamp) {
+        onStartSegment(recordId, segmentId, stamp);
+    };
+    loadActions.endSegment = [this](RecordId recordId, SegmentId segmentId, const ClickStamper::Stamp &stamp) {
+        onEndSegment(recordId, segmentId, stamp);
+    };
+    loadActions.clearSession = [this]() { clearSession(); };
+    loadActions.setJournaling = [this](bool enabled) {
+        if (journal) {
+            service->call([this, enabled](TimerEngine &e) { enabled ? journal->resume(e) : journal->suspend(e); });
+        }
+    };
+    loadGenerator = new LoadGenerator(*service, timingStats, this, loadActions, this);
+
+    // 诊断面板默认隐藏，Ctrl+Shift+D 切换
+    diagnosticsPanel = new DiagnosticsPanel(timingStats, loadGenerator, mainWidget);
+    diagnosticsPanel->hide();
+    connect(diagnosticsPanel, &DiagnosticsPanel::message, this, &TimerDock::showErrorMessage);
+    mainLayout->addWidget(diagnosticsPanel);
+    auto diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    diagnosticsShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(diagnosticsShortcut, &QShortcut::activated, this,
+            [this]() { diagnosticsPanel->setVisible(!diagnosticsPanel->isVisible()); });
+
+    // 导出进度，只在导出期间显示
+    exportProgress = new QProgressBar(mainWidget);
+    exportProgress->setRange(0, 100);
+    exportProgress->setFormat(tr("正在导出 %p%"));
+    exportProgress->hide();
+    mainLayout->addWidget(exportProgress);
 
     // Bottom buttons group
     auto bottomGroup = new QWidget();
@@ -275,573 +377,454 @@ void TimerDock::setupUI()
     connect(exportTextButton, &QPushButton::clicked, this, &TimerDock::exportToText);
     bottomLayout->addWidget(exportTextButton);
 
+    // 批量操作
+    auto moreButton = new QPushButton(tr("更多"), bottomGroup);
+    moreButton->setMinimumWidth(80);
+    auto moreMenu = new QMenu(moreButton);
+    moreMenu->addAction(tr("导入议程..."), this, &TimerDock::importAgenda);
+    moreMenu->addAction(tr("删除已结束的记录"), this, &TimerDock::deleteFinishedRecords);
+    moreMenu->addAction(tr("重置所有记录"), this, &TimerDock::resetSession);
+    moreMenu->addAction(tr("导出历史统计..."), this, &TimerDock::exportHistory);
+    moreButton->setMenu(moreMenu);
+    bottomLayout->addWidget(moreButton);
+
     // Appreciation button
     auto appreciationButton = new QPushButton(tr("赞赏我"), bottomGroup);
     appreciationButton->setMinimumWidth(80);
     connect(appreciationButton, &QPushButton::clicked, this, &TimerDock::showAppreciation);
     bottomLayout->addWidget(appreciationButton);
 
-    recordsLayout->addWidget(bottomGroup);
+    mainLayout->addWidget(bottomGroup);
 
-    scrollArea->setWidget(scrollWidget);
-    mainLayout->addWidget(scrollArea);
-    
     setWidget(mainWidget);
+    rebuildTimeStyles();
 
     // 创建默认的记录项
-    onAddRecord();
+    if (!restoreSession()) {
+        onAddRecord();
+    }
 }
 
-QWidget *TimerDock::createRecordWidget(int index)
+void TimerDock::setRecordExpanded(RecordId recordId, bool expanded)
 {
-    RecordWidgets widgets;
-    QWidget *container = new QWidget();
-    widgets.container = container;
-    QVBoxLayout *containerLayout = new QVBoxLayout(container);
-    containerLayout->setContentsMargins(0, 0, 0, 0);
-    containerLayout->setSpacing(6);
-
-    // Top row
-    QWidget *topWidget = new QWidget(container);
-    QHBoxLayout *topLayout = new QHBoxLayout(topWidget);
-    topLayout->setContentsMargins(0, 0, 0, 0);
-    topLayout->setSpacing(6);
-
-    // Type combo
-    widgets.typeCombo = new QComboBox(topWidget);
-    widgets.typeCombo->addItem("讲者", static_cast<int>(SpeakerType::Speaker));
-    widgets.typeCombo->addItem("讨论嘉宾", static_cast<int>(SpeakerType::Discussant));
-    widgets.typeCombo->setFixedWidth(100);
-    topLayout->addWidget(widgets.typeCombo);
-
-    // Name edit
-    widgets.nameEdit = new QLineEdit(topWidget);
-    widgets.nameEdit->setPlaceholderText("姓名");
-    widgets.nameEdit->setFixedWidth(100);
-    topLayout->addWidget(widgets.nameEdit);
-
-    // Add segment button
-    widgets.addButton = new QPushButton("+", topWidget);
-    widgets.addButton->setMinimumWidth(80);
-    topLayout->addWidget(widgets.addButton);
-
-    // Collapse/Expand button
-    QPushButton *expandBtn = new QPushButton("收起", topWidget);
-    expandBtn->setMinimumWidth(80);
-    expandBtn->setProperty("recordIndex", index);
-    expandBtn->setObjectName("expandBtn");
-    topLayout->addWidget(expandBtn);
-
-    // Total time label
-    widgets.totalLabel = new QLabel("累计: 00:00", topWidget);
-    widgets.totalLabel->setMinimumWidth(80);
-    widgets.totalLabel->setAlignment(Qt::AlignCenter);
-    
-    // 获取系统主题颜色
-    QPalette pal = palette();
-    QColor bgColor = pal.color(QPalette::Button);
-    QColor textCol = pal.color(QPalette::ButtonText);
-    QColor borderCol = pal.color(QPalette::Mid);
-    
-    widgets.totalLabel->setStyleSheet(QString("QLabel { padding: 4px; border: 0.5px solid %3; border-radius: 2px; background-color: %1; color: %2; font-weight: bold; font-size: 14px; min-height: 24px; }")
-        .arg(bgColor.name())
-        .arg(textCol.name())
-        .arg(borderCol.name()));
-    
-    topLayout->addWidget(widgets.totalLabel);
-
-    // Delete button
-    widgets.deleteButton = new QPushButton("删除", topWidget);
-    widgets.deleteButton->setMinimumWidth(80);
-    topLayout->addWidget(widgets.deleteButton);
+    if (!expanded) {
+        recordModel->collapse(recordId);
+        return;
+    }
+    if (recordModel->isExpanded(recordId)) {
+        return;
+    }
 
-    containerLayout->addWidget(topWidget);
+    // 收起的记录不保存时段，展开时一次往返取回全部时段
+    TimerClock &clock = service->timerClock();
+    auto segments = service->call([recordId, &clock](TimerEngine &e) {
+        int64_t nowNs = clock.nowNs();
+        QVector<RecordListModel::SegmentItem> result;
+        const TimerRecord *record = e.findRecord(recordId);
+        if (!record) {
+            return result;
+        }
+        result.reserve(static_cast<int>(record->segments.size()));
+        for (SegmentId id : record->segments) {
+            const TimerSegment *segment = e.findSegment(id);
+            result.append({id, segment->startNs, segment->endNs, segment->startLatencyNs, segment->endLatencyNs,
+                           TimeReading{segment->durationNs(nowNs), e.segmentState(id, nowNs)}});
+        }
+        return result;
+    });
+    recordModel->expand(recordId, segments);
+}
 
-    // Create a container for segments
-    QWidget *segmentsWrapper = new QWidget(container);
-    segmentsWrapper->setObjectName("segmentsWrapper");  // 添加对象名称以便查找
-    QVBoxLayout *wrapperLayout = new QVBoxLayout(segmentsWrapper);
-    wrapperLayout->setContentsMargins(0, 0, 0, 0);
-    wrapperLayout->setSpacing(0);
-    
-    // Segments container
-    widgets.segmentsContainer = new QFrame(segmentsWrapper);
-    widgets.segmentsLayout = new QVBoxLayout(widgets.segmentsContainer);
-    widgets.segmentsLayout->setContentsMargins(216, 0, 0, 0);
-    widgets.segmentsLayout->setSpacing(6);
-    
-    // Add segments container to wrapper
-    wrapperLayout->addWidget(widgets.segmentsContainer);
-    wrapperLayout->addStretch();
-    containerLayout->addWidget(segmentsWrapper);
-
-    // Initialize record data
-    widgets.record.isExpanded = true;
-    widgets.record.type = SpeakerType::Discussant;
-
-    // Store widgets in records vector
-    records.push_back(widgets);
-
-    // Connect signals after adding to records vector
-    connect(widgets.addButton, &QPushButton::clicked,
-            [this, index]() { onAddSegment(index); });
-    connect(widgets.deleteButton, &QPushButton::clicked,
-            [this, index]() { onDeleteRecord(index); });
-    connect(widgets.typeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
-            [this, index](int idx) { 
-                records[index].record.type = static_cast<SpeakerType>(idx);
-                updateTotalTime(index);  // 更新总时间显示，这会重新判断是否达标
-            });
-    connect(widgets.nameEdit, &QLineEdit::textChanged,
-            [this, index](const QString &text) { records[index].record.name = text; });
-    connect(expandBtn, &QPushButton::clicked,
-            [this, index, expandBtn]() {
-                auto &record = records[index];
-                record.record.isExpanded = !record.record.isExpanded;
-                
-                // 查找segmentsWrapper
-                QWidget *segmentsWrapper = record.container->findChild<QWidget*>("segmentsWrapper");
-                if (segmentsWrapper) {
-                    segmentsWrapper->setVisible(record.record.isExpanded);
-                    expandBtn->setText(record.record.isExpanded ? "收起" : "展开");
-                    
-                    // 强制更新布局
-                    record.container->adjustSize();
-                    if (QWidget *parent = record.container->parentWidget()) {
-                        parent->adjustSize();
-                    }
-                }
-            });
+void TimerDock::updateRecordsOfType(SpeakerType type)
+{
+    // 一次往返取回该类型所有记录的总计
+    TimerClock &clock = service->timerClock();
+    auto readings = service->call([type, &clock](TimerEngine &e) {
+        int64_t nowNs = clock.nowNs();
+        std::vector<std::pair<RecordId, TimeReading>> result;
+        for (RecordId id = e.firstRecord(); id != NO_ID; id = e.nextRecord(id)) {
+            if (e.findRecord(id)->type == type) {
+                result.emplace_back(id, TimeReading{e.totalNs(id, nowNs), e.totalState(id, nowNs)});
+            }
+        }
+        return result;
+    });
+    for (const auto &item : readings) {
+        updateTotalTime(item.first, item.second);
+    }
+}
 
-    return container;
+void TimerDock::setMinTimeMinutes(SpeakerType type, int minutes)
+{
+    service->call([type, minutes](TimerEngine &e) { e.setMinTimeMinutes(type, minutes); });
 }
 
-QWidget *TimerDock::createSegmentWidget(int recordIndex, int segmentIndex)
+int TimerDock::minTimeMinutes(SpeakerType type)
 {
-    SegmentWidgets widgets;
-    QWidget *container = new QWidget();
-    widgets.container = container;
-    QHBoxLayout *layout = new QHBoxLayout(container);
-    layout->setContentsMargins(0, 0, 0, 0);
-    layout->setSpacing(6);
-
-    // Start button
-    widgets.startButton = new QPushButton("记录开始时间", container);
-    widgets.startButton->setMinimumWidth(80);
-    widgets.startButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-    layout->addWidget(widgets.startButton);
-
-    // End button
-    widgets.endButton = new QPushButton("记录结束时间", container);
-    widgets.endButton->setMinimumWidth(80);
-    widgets.endButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-    widgets.endButton->setEnabled(false);
-    layout->addWidget(widgets.endButton);
-
-    // Duration label
-    widgets.durationLabel = new QLabel("00:00", container);
-    widgets.durationLabel->setMinimumWidth(80);
-    widgets.durationLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-    widgets.durationLabel->setAlignment(Qt::AlignCenter);
-    
-    // 获取系统主题颜色
-    QPalette pal = palette();
-    QColor bgColor = pal.color(QPalette::Button);
-    QColor textCol = pal.color(QPalette::ButtonText);
-    QColor borderCol = pal.color(QPalette::Mid);
-    
-    widgets.durationLabel->setStyleSheet(QString("QLabel { padding: 4px; border: 0.5px solid %3; border-radius: 2px; background-color: %1; color: %2; font-weight: bold; font-size: 14px; min-height: 24px; }")
-        .arg(bgColor.name())
-        .arg(textCol.name())
-        .arg(borderCol.name()));
-    
-    layout->addWidget(widgets.durationLabel);
-
-    // Delete button
-    widgets.deleteButton = new QPushButton("删除", container);
-    widgets.deleteButton->setMinimumWidth(80);
-    widgets.deleteButton->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-    layout->addWidget(widgets.deleteButton);
-
-    // Connect signals
-    connect(widgets.startButton, &QPushButton::clicked,
-            [this, recordIndex, segmentIndex]() { onStartSegment(recordIndex, segmentIndex); });
-    connect(widgets.endButton, &QPushButton::clicked,
-            [this, recordIndex, segmentIndex]() { onEndSegment(recordIndex, segmentIndex); });
-    connect(widgets.deleteButton, &QPushButton::clicked,
-            [this, recordIndex, segmentIndex]() { onDeleteSegment(recordIndex, segmentIndex); });
-
-    // Add to record's segments
-    records[recordIndex].segments.push_back(widgets);
-    records[recordIndex].record.segments.push_back(TimerSegment());
-
-    return container;
+    return service->call([type](TimerEngine &e) { return e.minTimeMinutes(type); });
 }
 
-void TimerDock::removeRecordWidgets(int index)
+void TimerDock::updateTotalTime(RecordId recordId, const TimeReading &reading)
 {
-    if (index >= 0 && index < records.size()) {
-        auto &widgets = records[index];
-        
-        // 先断开所有信号连接
-        widgets.addButton->disconnect();
-        widgets.deleteButton->disconnect();
-        widgets.typeCombo->disconnect();
-        widgets.nameEdit->disconnect();
-        
-        // 找到并断开展开/收起按钮的连接
-        QPushButton *expandBtn = widgets.container->findChild<QPushButton*>("expandBtn");
-        if (expandBtn) {
-            expandBtn->disconnect();
-        }
-        
-        // 从布局中移除并删除容器
-        recordsLayout->removeWidget(widgets.container);
-        delete widgets.container;
-        records.erase(records.begin() + index);
-        
-        // 更新剩余记录的索引
-        for (int i = index; i < records.size(); i++) {
-            auto &record = records[i];
-            
-            // 重新连接信号
-            connect(record.addButton, &QPushButton::clicked,
-                    [this, i]() { onAddSegment(i); });
-            connect(record.deleteButton, &QPushButton::clicked,
-                    [this, i]() { onDeleteRecord(i); });
-            connect(record.typeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
-                    [this, i](int idx) { records[i].record.type = static_cast<SpeakerType>(idx); });
-            connect(record.nameEdit, &QLineEdit::textChanged,
-                    [this, i](const QString &text) { records[i].record.name = text; });
-            
-            // 重新连接展开/收起按钮
-            QPushButton *expandBtn = record.container->findChild<QPushButton*>("expandBtn");
-            if (expandBtn) {
-                connect(expandBtn, &QPushButton::clicked,
-                        [this, i, expandBtn]() {
-                            auto &record = records[i];
-                            record.record.isExpanded = !record.record.isExpanded;
-                            
-                            QWidget *segmentsWrapper = record.container->findChild<QWidget*>("segmentsWrapper");
-                            if (segmentsWrapper) {
-                                segmentsWrapper->setVisible(record.record.isExpanded);
-                                expandBtn->setText(record.record.isExpanded ? "收起" : "展开");
-                                
-                                record.container->adjustSize();
-                                if (QWidget *parent = record.container->parentWidget()) {
-                                    parent->adjustSize();
-                                }
-                            }
-                        });
-            }
-        }
-    }
+    ProfileScope profile(ProfileName::UPDATE_TOTAL_TIME);
+    // 只有显示的秒数或达标状态变化时模型才通知视图，且只重绘可见的行
+    recordModel->setTotalTime(recordId, reading);
 }
 
-void TimerDock::removeSegmentWidgets(int recordIndex, int segmentIndex)
+void TimerDock::changeEvent(QEvent *event)
 {
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        auto &record = records[recordIndex];
-        if (segmentIndex >= 0 && segmentIndex < record.segments.size()) {
-            auto &widgets = record.segments[segmentIndex];
-            record.segmentsLayout->removeWidget(widgets.container);
-            delete widgets.container;
-            record.segments.erase(record.segments.begin() + segmentIndex);
-            
-            // 更新剩余时间段的按钮连接
-            for (int i = segmentIndex; i < record.segments.size(); i++) {
-                auto &segWidgets = record.segments[i];
-                
-                // 断开旧连接
-                segWidgets.startButton->disconnect();
-                segWidgets.endButton->disconnect();
-                segWidgets.deleteButton->disconnect();
-                
-                // 重新连接信号
-                connect(segWidgets.startButton, &QPushButton::clicked,
-                        [this, recordIndex, i]() { onStartSegment(recordIndex, i); });
-                connect(segWidgets.endButton, &QPushButton::clicked,
-                        [this, recordIndex, i]() { onEndSegment(recordIndex, i); });
-                connect(segWidgets.deleteButton, &QPushButton::clicked,
-                        [this, recordIndex, i]() { onDeleteSegment(recordIndex, i); });
-            }
-        }
+    QDockWidget::changeEvent(event);
+
+    // 切换主题时按新的系统颜色重新生成样式
+    if (event->type() == QEvent::PaletteChange) {
+        rebuildTimeStyles();
     }
 }
 
-void TimerDock::updateTotalTime(int recordIndex)
+void TimerDock::rebuildTimeStyles()
 {
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        auto &record = records[recordIndex];
-        QTime totalTime(0, 0);
-
-        for (const auto &segment : record.record.segments) {
-            if (!segment.startTime.isNull()) {
-                QTime endTime = segment.endTime.isNull() ? QTime::currentTime() : segment.endTime;
-                int secs = segment.startTime.secsTo(endTime);
-                totalTime = totalTime.addSecs(secs);
-            }
-        }
+    if (!mainWidget) {
+        return;
+    }
 
-        record.record.totalTime = totalTime;  // 保存总时间
-        record.totalLabel->setText(QString("累计: %1").arg(formatTime(totalTime)));
-
-        // 根据时间是否为0和是否达标设置不同的背景色
-        bool isZero = totalTime == QTime(0, 0);
-        bool isReached = isMinTimeReached(recordIndex);
-        QString backgroundColor;
-        QString textColor;
-        QString borderColor;
-        
-        if (isZero) {
-            // 获取系统主题颜色
-            QPalette pal = palette();
-            QColor bgColor = pal.color(QPalette::Button);
-            QColor textCol = pal.color(QPalette::ButtonText);
-            QColor borderCol = pal.color(QPalette::Mid);
-            
-            backgroundColor = bgColor.name();
-            textColor = textCol.name();
-            borderColor = borderCol.name();
-        } else if (isReached) {
-            backgroundColor = "#548235";  // 达标时的背景色改为深绿色
-            textColor = "white";
-            borderColor = "white";
-        } else {
-            backgroundColor = "#c00000";
-            textColor = "white";
-            borderColor = "white";
-        }
-        
-        record.totalLabel->setStyleSheet(QString("QLabel { padding: 4px; border: 0.5px solid %3; border-radius: 2px; background-color: %1; color: %2; font-weight: bold; font-size: 14px; min-height: 24px; }")
-            .arg(backgroundColor)
-            .arg(textColor)
-            .arg(borderColor));
+    // 三种状态的样式一次生成，标签只通过 timeState 动态属性切换，
+    // 每次刷新不再拼接和解析样式表
+    QPalette pal = palette();
+    const QString rule = "QLabel[timeState=\"%1\"] { padding: 4px; border: 0.5px solid %4; border-radius: 2px; background-color: %2; color: %3; font-weight: bold; font-size: 14px; min-height: 24px; }\n";
+    QString styleSheet = rule.arg("zero", pal.color(QPalette::Button).name(),
+                                  pal.color(QPalette::ButtonText).name(), pal.color(QPalette::Mid).name())
+                       + rule.arg("reached", "#548235", "white", "white")  // 达标时的背景色为深绿色
+                       + rule.arg("below", "#c00000", "white", "white");
+
+    if (styleSheet != mainWidget->styleSheet()) {
+        mainWidget->setStyleSheet(styleSheet);
+        // 时间标签的内边距和最小高度决定行高
+        recordView->resetRowSize();
     }
 }
 
 void TimerDock::onAddRecord()
 {
+    // 角色与类型下拉框的默认项一致
+    RecordId lastId = NO_ID;
+    RecordId recordId = service->call([&lastId](TimerEngine &e) {
+        lastId = e.lastRecord();
+        return e.addRecord(SpeakerType::Speaker);
+    });
+
     // 如果有现有记录，收起最后一条记录
-    if (!records.empty()) {
-        int lastIndex = records.size() - 1;
-        auto &lastRecord = records[lastIndex];
-        lastRecord.record.isExpanded = false;
-        
-        // 查找并隐藏segmentsWrapper
-        QWidget *segmentsWrapper = lastRecord.container->findChild<QWidget*>("segmentsWrapper");
-        if (segmentsWrapper) {
-            segmentsWrapper->setVisible(false);
-        }
-        
-        // 更新按钮文本
-        QPushButton *expandBtn = lastRecord.container->findChild<QPushButton*>("expandBtn");
-        if (expandBtn) {
-            expandBtn->setText("展开");
-        }
+    if (lastId != NO_ID) {
+        setRecordExpanded(lastId, false);
     }
+    recordModel->appendRecord(recordId, SpeakerType::Speaker);
 
-    int newIndex = records.size();
-    QWidget *recordWidget = createRecordWidget(newIndex);
-    if (recordsLayout->count() > 1) {
-        recordsLayout->insertWidget(recordsLayout->count() - 2, recordWidget);
-    } else {
-        recordsLayout->insertWidget(0, recordWidget);
+    // 为每个新增的记录项自动添加一个时间段
+    onAddSegment(recordId);
+    // 新记录在最后，滚动到它的时段行
+    recordView->scrollToRow(recordModel->rowCount() - 1);
+}
+
+void TimerDock::onDeleteRecord(RecordId recordId)
+{
+    ProfileScope profile(ProfileName::DELETE_RECORD);
+    // 如果删除的是最后一条记录，展开倒数第二条记录
+    RecordId prevId = service->call([recordId](TimerEngine &e) {
+        RecordId prev = recordId == e.lastRecord() ? e.prevRecord(recordId) : NO_ID;
+        e.removeRecord(recordId);
+        return prev;
+    });
+    if (prevId != NO_ID) {
+        setRecordExpanded(prevId, true);
     }
 
-    // 为每个新增的记录项自动添加一个时间段
-    onAddSegment(newIndex);
+    recordModel->removeRecord(recordId);
+    tickScheduler->setRunning(service->hasRunningSegments());
+}
 
-    // 更新所有记录项的删除按钮可见性
-    updateRecordDeleteButtonsVisibility();
+template <typename Fn>
+void TimerDock::runBatch(Fn fn)
+{
+    mainWidget->setUpdatesEnabled(false);
+    recordModel->beginBatch();
+    fn();
+    recordModel->endBatch();
+    tickScheduler->setRunning(service->hasRunningSegments());
+    mainWidget->setUpdatesEnabled(true);
 }
 
-void TimerDock::onDeleteRecord(int index)
+void TimerDock::importAgenda()
 {
-    // 如果删除的是最后一条记录，不需要特殊处理
-    if (records.size() <= 1) {
-        removeRecordWidgets(index);
-        updateRecordDeleteButtonsVisibility();
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    QString filePath = QFileDialog::getOpenFileName(this, tr("导入议程"), defaultPath, tr("文本文件 (*.txt)"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        showErrorMessage("打开文件失败");
         return;
     }
 
-    // 如果删除的是最后一条记录，展开倒数第二条记录
-    if (index == records.size() - 1) {
-        int prevIndex = index - 1;
-        auto &prevRecord = records[prevIndex];
-        prevRecord.record.isExpanded = true;
-        
-        // 查找并显示segmentsWrapper
-        QWidget *segmentsWrapper = prevRecord.container->findChild<QWidget*>("segmentsWrapper");
-        if (segmentsWrapper) {
-            segmentsWrapper->setVisible(true);
-        }
-        
-        // 更新按钮文本
-        QPushButton *expandBtn = prevRecord.container->findChild<QPushButton*>("expandBtn");
-        if (expandBtn) {
-            expandBtn->setText("收起");
+    // 每行一条记录："姓名" 或 "姓名<Tab>角色"，角色缺省为讲者
+    QVector<QPair<QString, SpeakerType>> agenda;
+    QTextStream stream(&file);
+    stream.setEncoding(QStringConverter::Utf8);
+    while (!stream.atEnd()) {
+        QStringList fields = stream.readLine().split('\t');
+        QString name = fields[0].trimmed();
+        if (name.isEmpty()) {
+            continue;
         }
+        bool discussant = fields.size() > 1 && fields[1].trimmed() == speakerTypeName(SpeakerType::Discussant);
+        agenda.append({name, discussant ? SpeakerType::Discussant : SpeakerType::Speaker});
+    }
+    if (agenda.isEmpty()) {
+        return;
     }
 
-    removeRecordWidgets(index);
-    updateRecordDeleteButtonsVisibility();
+    // 一次往返添加全部记录，每条记录带一个时段
+    std::vector<std::pair<RecordId, SegmentId>> added;
+    RecordId lastId = service->call([&agenda, &added](TimerEngine &e) {
+        RecordId last = e.lastRecord();
+        added.reserve(agenda.size());
+        for (const auto &row : agenda) {
+            RecordId id = e.addRecord(row.second);
+            e.setRecordName(id, row.first.toStdString());
+            SegmentId segmentId = NO_ID;
+            e.addSegment(id, &segmentId);
+            added.emplace_back(id, segmentId);
+        }
+        return last;
+    });
+
+    // 与逐条添加一致：只有最后一条记录展开
+    runBatch([&]() {
+        if (lastId != NO_ID) {
+            setRecordExpanded(lastId, false);
+        }
+        for (size_t i = 0; i < added.size(); ++i) {
+            RecordId id = added[i].first;
+            recordModel->appendRecord(id, agenda[static_cast<int>(i)].second);
+            recordModel->setName(id, agenda[static_cast<int>(i)].first);
+            if (i + 1 < added.size()) {
+                recordModel->collapse(id);
+            } else {
+                recordModel->appendSegment(id, added[i].second);
+            }
+        }
+    });
+    recordView->scrollToRow(recordModel->rowCount() - 1);
 }
 
-void TimerDock::onAddSegment(int recordIndex)
+void TimerDock::deleteFinishedRecords()
 {
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        auto &record = records[recordIndex];
-        
-        // 检查是否有未使用的时间段或正在计时的时间段
-        bool hasUnusedSegment = false;
-        bool hasRunningSegment = false;
-        for (const auto &segment : record.record.segments) {
-            if (segment.startTime.isNull()) {
-                hasUnusedSegment = true;
-                break;
+    // 所有时段都已结束的记录视为已结束
+    std::vector<RecordId> removed;
+    RecordId lastId = service->call([&removed](TimerEngine &e) {
+        for (RecordId id = e.firstRecord(); id != NO_ID;) {
+            RecordId next = e.nextRecord(id);
+            const TimerRecord *record = e.findRecord(id);
+            bool finished = !record->segments.empty();
+            for (SegmentId segmentId : record->segments) {
+                finished = finished && e.findSegment(segmentId)->isEnded();
             }
-            if (segment.isRunning) {
-                hasRunningSegment = true;
-                break;
+            if (finished) {
+                removed.push_back(id);
+                e.removeRecord(id);
             }
+            id = next;
         }
-        
-        if (hasUnusedSegment) {
-            showErrorMessage("请先使用现有的时段");
-            return;
+        return e.lastRecord();
+    });
+    if (removed.empty()) {
+        return;
+    }
+
+    runBatch([&]() {
+        for (RecordId id : removed) {
+            recordModel->removeRecord(id);
         }
-        
-        if (hasRunningSegment) {
-            showErrorMessage("请先结束当前正在计时的时段");
-            return;
+        // 至少保留一条记录，最后一条记录保持展开
+        if (lastId == NO_ID) {
+            onAddRecord();
+        } else {
+            setRecordExpanded(lastId, true);
         }
+    });
+}
 
-        int segmentIndex = record.segments.size();
-        QWidget *segmentWidget = createSegmentWidget(recordIndex, segmentIndex);
-        record.segmentsLayout->addWidget(segmentWidget);
-
-        // 更新时间段删除按钮的可见性
-        updateSegmentDeleteButtonsVisibility(recordIndex);
+void TimerDock::resetSession()
+{
+    if (QMessageBox::question(this, tr("重置所有记录"), tr("确定删除所有记录并重新开始吗？"))
+        != QMessageBox::Yes) {
+        return;
     }
+
+    archiveSession();
+    clearSession();
 }
 
-void TimerDock::onDeleteSegment(int recordIndex, int segmentIndex)
+void TimerDock::clearSession()
 {
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        auto &record = records[recordIndex];
-        if (segmentIndex >= 0 && segmentIndex < record.segments.size()) {
-            // 获取要删除的时间段
-            const auto &segment = record.record.segments[segmentIndex];
-            
-            // 如果时间段有开始和结束时间，从总时间中减去这段时间
-            if (!segment.startTime.isNull() && !segment.endTime.isNull()) {
-                int secs = segment.startTime.secsTo(segment.endTime);
-                record.record.totalTime = record.record.totalTime.addSecs(-secs);
-            }
-            
-            // 删除时间段组件
-            removeSegmentWidgets(recordIndex, segmentIndex);
-            record.record.segments.erase(record.record.segments.begin() + segmentIndex);
-            
-            // 更新总计时间显示
-            updateTotalTime(recordIndex);
-            
-            // 更新时间段删除按钮的可见性
-            updateSegmentDeleteButtonsVisibility(recordIndex);
+    service->call([](TimerEngine &e) {
+        while (e.firstRecord() != NO_ID) {
+            e.removeRecord(e.firstRecord());
         }
+    });
+    runBatch([this]() {
+        recordModel->clear();
+        onAddRecord();
+    });
+}
+
+void TimerDock::archiveSession()
+{
+    // 压力测试生成的记录不归档
+    if (archiveDirectory.isEmpty() || !service || loadGenerator->isRunning()) {
+        return;
+    }
+    const TimerEngine engine = service->call([](TimerEngine &e) { return e; });
+    if (!SessionArchive(archiveDirectory.toStdString()).add(engine, service->nowNs())) {
+        blog(LOG_WARNING, "[obs-speech-timer] Cannot archive the session to %s",
+             archiveDirectory.toUtf8().constData());
     }
 }
 
-void TimerDock::onStartSegment(int recordIndex, int segmentIndex)
+bool TimerDock::restoreSession()
 {
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        auto &record = records[recordIndex];
-        if (segmentIndex >= 0 && segmentIndex < record.segments.size()) {
-            auto &segment = record.record.segments[segmentIndex];
-            auto &widgets = record.segments[segmentIndex];
-            
-            QTime currentTime = QTime::currentTime();
-            segment.startTime = currentTime;
-            segment.isRunning = true;
-            
-            widgets.startButton->setEnabled(false);
-            widgets.startButton->setText(currentTime.toString("HH:mm:ss"));
-            widgets.endButton->setEnabled(true);
+    if (journalPath.isEmpty()) {
+        return false;
+    }
+    int64_t startNs = timerNowNs();
+
+    journal = std::make_unique<SessionJournal>(journalPath.toStdString());
+    SessionJournal::Status status = service->call([this](TimerEngine &e) { return journal->open(e); });
+    if (status == SessionJournal::Status::IoError) {
+        blog(LOG_WARNING, "[obs-speech-timer] Cannot write session journal %s", journalPath.toUtf8().constData());
+        journal.reset();
+        return false;
+    }
+    if (status == SessionJournal::Status::Corrupt) {
+        blog(LOG_WARNING, "[obs-speech-timer] Discarded an unreadable session journal");
+    }
+    if (status != SessionJournal::Status::Recovered) {
+        return false;
+    }
+
+    // 一次往返取回恢复的全部记录
+    std::vector<std::tuple<RecordId, SpeakerType, std::string>> records = service->call([](TimerEngine &e) {
+        std::vector<std::tuple<RecordId, SpeakerType, std::string>> result;
+        for (RecordId id = e.firstRecord(); id != NO_ID; id = e.nextRecord(id)) {
+            const TimerRecord *record = e.findRecord(id);
+            result.emplace_back(id, record->type, record->name);
         }
+        return result;
+    });
+    if (records.empty()) {
+        return false;
     }
+
+    // 与平时一致：只有最后一条记录展开
+    runBatch([&]() {
+        for (const auto &record : records) {
+            RecordId id = std::get<0>(record);
+            recordModel->appendRecord(id, std::get<1>(record));
+            recordModel->setName(id, QString::fromStdString(std::get<2>(record)));
+            recordModel->collapse(id);
+        }
+        setRecordExpanded(std::get<0>(records.back()), true);
+    });
+    updateRecordsOfType(SpeakerType::Speaker);
+    updateRecordsOfType(SpeakerType::Discussant);
+    recordView->scrollToRow(recordModel->rowCount() - 1);
+
+    blog(LOG_INFO, "[obs-speech-timer] Recovered %d records (%d events) from the session journal in %.2f ms",
+         static_cast<int>(records.size()), journal->recoveredEvents(),
+         static_cast<double>(timerNowNs() - startNs) / NS_PER_MS);
+    return true;
 }
 
-void TimerDock::onEndSegment(int recordIndex, int segmentIndex)
+void TimerDock::onAddSegment(RecordId recordId)
 {
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        auto &record = records[recordIndex];
-        if (segmentIndex >= 0 && segmentIndex < record.segments.size()) {
-            auto &segment = record.record.segments[segmentIndex];
-            auto &widgets = record.segments[segmentIndex];
-            
-            QTime currentTime = QTime::currentTime();
-            segment.endTime = currentTime;
-            segment.isRunning = false;
-            
-            widgets.startButton->setEnabled(false);
-            widgets.endButton->setEnabled(false);
-            widgets.endButton->setText(currentTime.toString("HH:mm:ss"));
-            
-            updateSegmentDisplay(recordIndex, segmentIndex);
-            updateTotalTime(recordIndex);
-        }
+    // 检查是否有未使用的时间段或正在计时的时间段
+    SegmentId segmentId = NO_ID;
+    TimerEngine::Result result = service->call(
+        [recordId, &segmentId](TimerEngine &e) { return e.addSegment(recordId, &segmentId); });
+    if (result == TimerEngine::Result::HasUnusedSegment) {
+        showErrorMessage("请先使用现有的时段");
+        return;
     }
+
+    if (result == TimerEngine::Result::HasRunningSegment) {
+        showErrorMessage("请先结束当前正在计时的时段");
+        return;
+    }
+
+    if (result != TimerEngine::Result::Ok) {
+        return;
+    }
+
+    recordModel->appendSegment(recordId, segmentId);
 }
 
-void TimerDock::exportToText()
+void TimerDock::onDeleteSegment(RecordId recordId, SegmentId segmentId)
+{
+    ProfileScope profile(ProfileName::DELETE_SEGMENT);
+    // 删除时间段数据和对应的行
+    service->call([segmentId](TimerEngine &e) { e.removeSegment(segmentId); });
+    recordModel->removeSegment(recordId, segmentId);
+    tickScheduler->setRunning(service->hasRunningSegments());
+
+    // 更新总计时间显示
+    updateTotalTime(recordId, service->recordTime(recordId));
+}
+
+void TimerDock::onStartSegment(RecordId recordId, SegmentId segmentId, const ClickStamper::Stamp &stamp)
 {
-    // 计算最大列宽
-    int roleWidth = 12;      // "讨论嘉宾" 长度为4个汉字
-    int nameWidth = 8;       // 至少保留8个字符的宽度
-    int timeWidth = 8;       // "HH:mm:ss" 长度为8
-    int durationWidth = 5;   // "mm:ss" 长度为5
-    int statusWidth = 4;     // "是/否" 长度为2个汉字
-
-    // 遍历所有记录以找到最长的名字
-    for (const auto &record : records) {
-        nameWidth = qMax(nameWidth, record.record.name.length());
+    int64_t handledNs = timerNowNs();
+    if (service->startSegment(segmentId, stamp.eventNs, stamp.latencyNs) != TimerEngine::Result::Ok) {
+        return;
     }
 
-    // 创建表头
-    QString text = QString("%1\t%2\t%3\t%4\t%5\t%6\n")
-        .arg("角色", -roleWidth)
-        .arg("姓名", -nameWidth)
-        .arg("开始时间", -timeWidth)
-        .arg("结束时间", -timeWidth)
-        .arg("累计时间", -durationWidth)
-        .arg("是否达标", -statusWidth);
-    
-    for (int i = 0; i < records.size(); ++i) {
-        const auto &record = records[i];
-        QString role = record.typeCombo->currentText();  // 从typeCombo获取当前选择的角色
-        QString name = record.record.name.isEmpty() ? "(未填写)" : record.record.name;
-        bool isReached = record.record.totalTime.minute() >= getMinTime(i);
-        
-        for (const auto &segment : record.record.segments) {
-            if (!segment.startTime.isNull()) {
-                QString startTime = segment.startTime.toString("HH:mm:ss");
-                QString endTime = segment.endTime.isNull() ? "进行中" : segment.endTime.toString("HH:mm:ss");
-                QString duration = formatTime(segment.endTime.isNull() ? 
-                    QTime(0, 0).addSecs(segment.startTime.secsTo(QTime::currentTime())) :
-                    QTime(0, 0).addSecs(segment.startTime.secsTo(segment.endTime)));
-                
-                text += QString("%1\t%2\t%3\t%4\t%5\t%6\n")
-                    .arg(role, -roleWidth)
-                    .arg(name, -nameWidth)
-                    .arg(startTime, -timeWidth)
-                    .arg(endTime, -timeWidth)
-                    .arg(duration, -durationWidth)
-                    .arg(isReached ? "是" : "否", -statusWidth);
-            }
-        }
+    // 点击延迟按真实时间统计，与计时所用的时钟无关
+    timingStats.clickLatency.record(stamp.latencyNs + (timerNowNs() - handledNs));
+    recordModel->setSegmentStart(recordId, segmentId, stamp.eventNs, stamp.latencyNs);
+    tickScheduler->setRunning(true);
+}
+
+void TimerDock::onEndSegment(RecordId recordId, SegmentId segmentId, const ClickStamper::Stamp &stamp)
+{
+    int64_t handledNs = timerNowNs();
+    // 结束时间和结束后的读数随结束一起取回，只往返计时线程一次
+    SegmentEnd ended = service->endSegment(segmentId, stamp.eventNs, stamp.latencyNs);
+    if (ended.result != TimerEngine::Result::Ok) {
+        return;
     }
+    timingStats.clickLatency.record(stamp.latencyNs + (timerNowNs() - handledNs));
+
+    recordModel->setSegmentEnd(recordId, segmentId, ended.endNs, stamp.latencyNs);
+    tickScheduler->setRunning(service->hasRunningSegments());
 
+    updateSegmentDisplay(recordId, segmentId, ended.segment);
+    updateTotalTime(recordId, ended.total);
+}
+
+void TimerDock::onRecordTypeChanged(RecordId recordId, SpeakerType type)
+{
+    service->call([recordId, type](TimerEngine &e) { e.setRecordType(recordId, type); });
+    recordModel->setType(recordId, type);
+    updateTotalTime(recordId, service->recordTime(recordId));  // 更新总时间显示，这会重新判断是否达标
+}
+
+void TimerDock::onRecordNameChanged(RecordId recordId, const QString &name)
+{
+    std::string utf8 = name.toStdString();
+    service->call([recordId, &utf8](TimerEngine &e) { e.setRecordName(recordId, utf8); });
+    recordModel->setName(recordId, name);
+}
+
+void TimerDock::exportToText()
+{
     // 生成默认文件名（使用当前日期时间）
     QString defaultFileName = QString("Speech_Timer_%1.txt")
         .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
@@ -854,174 +837,133 @@ void TimerDock::exportToText()
         tr("文本文件 (*.txt)"));
 
     if (!filePath.isEmpty()) {
-        QFile file(filePath);
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QTextStream stream(&file);
-            stream.setEncoding(QStringConverter::Utf8);
-            stream << text;
-            file.close();
-            showErrorMessage("文件已保存");
-        } else {
-            showErrorMessage("保存文件失败");
-        }
+        startExport(ExportFormat::Text, filePath);
     }
 }
 
 void TimerDock::exportToExcel()
 {
-    QString csv = "角色,姓名,开始时间,结束时间,累计时间,是否达标\n";
-    
-    for (int i = 0; i < records.size(); ++i) {
-        const auto &record = records[i];
-        QString role = record.typeCombo->currentText();  // 从typeCombo获取当前选择的角色
-        QString name = record.record.name.isEmpty() ? "(未填写)" : record.record.name;
-        bool isReached = record.record.totalTime.minute() >= getMinTime(i);
-        
-        for (const auto &segment : record.record.segments) {
-            if (!segment.startTime.isNull()) {
-                QString startTime = segment.startTime.toString("HH:mm:ss");
-                QString endTime = segment.endTime.isNull() ? "进行中" : segment.endTime.toString("HH:mm:ss");
-                QString duration = formatTime(segment.endTime.isNull() ? 
-                    QTime(0, 0).addSecs(segment.startTime.secsTo(QTime::currentTime())) :
-                    QTime(0, 0).addSecs(segment.startTime.secsTo(segment.endTime)));
-                
-                // 处理CSV中的特殊字符
-                if (name.contains(",")) {
-                    name = QString("\"%1\"").arg(name);
-                }
-                
-                csv += QString("%1,%2,%3,%4,%5,%6\n")
-                    .arg(role)
-                    .arg(name)
-                    .arg(startTime)
-                    .arg(endTime)
-                    .arg(duration)
-                    .arg(isReached ? "是" : "否");
-            }
-        }
-    }
-
     // 生成默认文件名（使用当前日期时间）
-    QString defaultFileName = QString("Speech_Timer_%1.csv")
+    QString defaultFileName = QString("Speech_Timer_%1.xlsx")
         .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
 
-    // 获取系统文档目录作为默认保存位置
+    // 获取系统文档目录作为默认保存位置；仍然可以选择保存为 CSV
     QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    QString xlsxFilter = tr("Excel 工作簿 (*.xlsx)");
+    QString csvFilter = tr("CSV文件 (*.csv)");
+    QString selectedFilter = xlsxFilter;
     QString filePath = QFileDialog::getSaveFileName(this,
-        tr("保存CSV文件"),
+        tr("保存表格文件"),
         defaultPath + "/" + defaultFileName,
-        tr("CSV文件 (*.csv)"));
+        xlsxFilter + ";;" + csvFilter,
+        &selectedFilter);
 
     if (!filePath.isEmpty()) {
-        QFile file(filePath);
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            // 写入 UTF-8 BOM，以确保Excel正确识别中文
-            file.write("\xEF\xBB\xBF");
-            
-            QTextStream stream(&file);
-            stream.setEncoding(QStringConverter::Utf8);
-            stream << csv;
-            file.close();
-            showErrorMessage("文件已保存");
-        } else {
-            showErrorMessage("保存文件失败");
-        }
+        bool csv = selectedFilter == csvFilter || filePath.endsWith(".csv", Qt::CaseInsensitive);
+        startExport(csv ? ExportFormat::Csv : ExportFormat::Xlsx, filePath);
     }
 }
 
-void TimerDock::showAppreciation()
+void TimerDock::startExport(ExportFormat format, const QString &filePath)
 {
-    AppreciationDialog *dialog = new AppreciationDialog(this);
-    dialog->setAttribute(Qt::WA_DeleteOnClose);
-    dialog->show();
+    if (exportJob) {
+        showErrorMessage("正在导出，请稍候");
+        return;
+    }
+
+    // 导出的内容以选定文件时为准：取计时线程上模型的一份副本，之后的修改不影响这次导出
+    const TimerEngine engine = service->call([](TimerEngine &e) { return e; });
+    runExportJob(new ExportJob(format, engine, service->nowNs(), filePath, this));
 }
 
-void TimerDock::updateAllTimes()
+void TimerDock::exportHistory()
 {
-    for (int i = 0; i < records.size(); ++i) {
-        auto &record = records[i];
-        for (int j = 0; j < record.segments.size(); ++j) {
-            if (record.record.segments[j].isRunning) {
-                updateSegmentDisplay(i, j);
-            }
-        }
-        updateTotalTime(i);
+    if (archiveDirectory.isEmpty()) {
+        showErrorMessage("没有历史会话");
+        return;
+    }
+    if (exportJob) {
+        showErrorMessage("正在导出，请稍候");
+        return;
+    }
+
+    QString defaultFileName = QString("Speech_Timer_History_%1.xlsx")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    QString filePath = QFileDialog::getSaveFileName(this,
+        tr("保存历史统计"),
+        defaultPath + "/" + defaultFileName,
+        tr("Excel 工作簿 (*.xlsx)"));
+    if (filePath.isEmpty()) {
+        return;
     }
+
+    // 只统计已归档的会话，当前会话在重置或关闭时才归档；映射归档和统计都在导出线程上进行
+    std::string directory = archiveDirectory.toStdString();
+    runExportJob(new ExportJob(filePath, [directory](QSaveFile &file, const ExportProgress &progress) {
+        SessionArchive archive(directory);
+        archive.load();
+        if (progress && !progress(0, 1)) {
+            return false;
+        }
+        SessionAnalytics analytics = analyzeSessions(archive.sessions());
+        bool ok = writeAnalyticsXlsx(analytics, [&file](const char *data, size_t size) {
+            return file.write(data, static_cast<qint64>(size)) == static_cast<qint64>(size);
+        });
+        return ok && (!progress || progress(1, 1));
+    }, this));
 }
 
-void TimerDock::updateSegmentDisplay(int recordIndex, int segmentIndex)
+void TimerDock::runExportJob(ExportJob *job)
 {
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        auto &record = records[recordIndex];
-        if (segmentIndex >= 0 && segmentIndex < record.segments.size()) {
-            auto &segment = record.record.segments[segmentIndex];
-            auto &widgets = record.segments[segmentIndex];
-
-            if (!segment.startTime.isNull()) {
-                QTime endTime = segment.endTime.isNull() ? QTime::currentTime() : segment.endTime;
-                int secs = segment.startTime.secsTo(endTime);
-                QTime duration = QTime(0, 0).addSecs(secs);
-                widgets.durationLabel->setText(formatTime(duration));
-
-                // 根据时间是否为0和是否达标设置不同的背景色
-                bool isZero = duration == QTime(0, 0);
-                int minTime = getMinTime(recordIndex);
-                bool isReached = duration.minute() >= minTime;
-                QString backgroundColor;
-                QString textColor;
-                QString borderColor;
-                
-                if (isZero) {
-                    // 获取系统主题颜色
-                    QPalette pal = palette();
-                    QColor bgColor = pal.color(QPalette::Button);
-                    QColor textCol = pal.color(QPalette::ButtonText);
-                    QColor borderCol = pal.color(QPalette::Mid);
-                    
-                    backgroundColor = bgColor.name();
-                    textColor = textCol.name();
-                    borderColor = borderCol.name();
-                } else if (isReached) {
-                    backgroundColor = "#548235";  // 达标时的背景色改为深绿色
-                    textColor = "white";
-                    borderColor = "white";
-                } else {
-                    backgroundColor = "#c00000";
-                    textColor = "white";
-                    borderColor = "white";
-                }
-                
-                widgets.durationLabel->setStyleSheet(QString("QLabel { padding: 4px; border: 0.5px solid %3; border-radius: 2px; background-color: %1; color: %2; font-weight: bold; font-size: 14px; min-height: 24px; }")
-                    .arg(backgroundColor)
-                    .arg(textColor)
-                    .arg(borderColor));
-            }
-        }
-    }
+    exportJob = job;
+    connect(exportJob, &ExportJob::progressChanged, exportProgress, &QProgressBar::setValue);
+    connect(exportJob, &ExportJob::finished, this, [this](bool ok) {
+        exportProgress->hide();
+        exportJob->deleteLater();
+        exportJob = nullptr;
+        showErrorMessage(ok ? "文件已保存" : "保存文件失败");
+    });
+
+    exportProgress->setValue(0);
+    exportProgress->show();
+    exportJob->start();
 }
 
-bool TimerDock::isMinTimeReached(int recordIndex) const
+void TimerDock::showAppreciation()
 {
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        const auto &record = records[recordIndex];
-        int minTime = getMinTime(recordIndex);
-        return record.record.totalTime.minute() >= minTime;
-    }
-    return false;
+    AppreciationDialog *dialog = new AppreciationDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
 }
 
-int TimerDock::getMinTime(int recordIndex) const
+void TimerDock::updateAllTimes()
 {
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        const auto &record = records[recordIndex];
-        return record.record.type == SpeakerType::Speaker ? customMinTimes[0] : customMinTimes[1];
+    ProfileScope profile(ProfileName::UPDATE_ALL_TIMES);
+    // 只读计时线程发布的快照，不加锁也不等待计时线程
+    const TimerSnapshot &snapshot = service->snapshot();
+    if (snapshot.running.empty()) {
+        return;
     }
-    return 0;
+
+    // 每次刷新只读一次时钟，所有记录按同一时刻推算
+    int64_t tickStartNs = timerNowNs();
+    int64_t nowNs = service->nowNs();
+    // 已停止的记录在结束/删除时段时已刷新过，这里只处理正在计时的记录
+    for (const RunningTime &entry : snapshot.running) {
+        // 收起的记录只刷新累计时间，时段在展开时重新读取
+        if (recordModel->isExpanded(entry.recordId)) {
+            updateSegmentDisplay(entry.recordId, entry.segmentId,
+                                 TimeReading{entry.segmentNsAt(nowNs), entry.segmentState});
+        }
+        updateTotalTime(entry.recordId, TimeReading{entry.totalNsAt(nowNs), entry.totalState});
+    }
+    timingStats.tickProcessing.record(timerNowNs() - tickStartNs);
 }
 
-QString TimerDock::formatTime(const QTime &time) const
+void TimerDock::updateSegmentDisplay(RecordId recordId, SegmentId segmentId, const TimeReading &reading)
 {
-    return time.toString("mm:ss");
+    recordModel->setSegmentTime(recordId, segmentId, reading);
 }
 
 void TimerDock::showErrorMessage(const QString &message)
@@ -1054,32 +996,4 @@ void TimerDock::hideErrorMessage()
     fadeAnimation->start();
 }
 
-void TimerDock::updateRecordDeleteButtonsVisibility()
-{
-    // 如果只有一个记录项，隐藏其删除按钮
-    if (records.size() == 1) {
-        records[0].deleteButton->hide();
-    } else {
-        // 否则显示所有记录项的删除按钮
-        for (auto &record : records) {
-            record.deleteButton->show();
-        }
-    }
-}
-
-void TimerDock::updateSegmentDeleteButtonsVisibility(int recordIndex)
-{
-    if (recordIndex >= 0 && recordIndex < records.size()) {
-        auto &record = records[recordIndex];
-        
-        // 如果只有一个时间段，隐藏其删除按钮
-        if (record.segments.size() == 1) {
-            record.segments[0].deleteButton->hide();
-        } else {
-            // 否则显示所有时间段的删除按钮
-            for (auto &segment : record.segments) {
-                segment.deleteButton->show();
-            }
-        }
-    }
-} 
\ No newline at end of file
+ 
\ No newline at end of file
@@ -2,44 +2,26 @@
 
 #include <QDockWidget>
 #include <QTimer>
-#include <QTime>
-#include <QVector>
+#include <QHash>
 #include <QPropertyAnimation>
 #include <QLabel>
+#include <memory>
 #include <vector>
-#include "timer-record.hpp"
+#include "timer-service.hpp"
+#include "click-stamp.hpp"
+#include "diagnostics-panel.hpp"
+#include "export-format.hpp"
 #include <QDialog>
 
 class QComboBox;
-class QLineEdit;
-class QPushButton;
-class QVBoxLayout;
-class QFrame;
-
-struct SegmentWidgets {
-    QWidget *container;
-    QPushButton *startButton;
-    QPushButton *endButton;
-    QLabel *durationLabel;
-    QPushButton *deleteButton;
-
-    SegmentWidgets() : container(nullptr), startButton(nullptr), 
-                      endButton(nullptr), durationLabel(nullptr),
-                      deleteButton(nullptr) {}
-};
-
-struct RecordWidgets {
-    QWidget *container;
-    QComboBox *typeCombo;
-    QLineEdit *nameEdit;
-    QPushButton *addButton;
-    QPushButton *deleteButton;
-    QLabel *totalLabel;
-    QFrame *segmentsContainer;
-    QVBoxLayout *segmentsLayout;
-    QVector<SegmentWidgets> segments;
-    TimerRecord record;
-};
+class QProgressBar;
+class TickScheduler;
+class RecordListModel;
+class RecordListView;
+class RecordRowDelegate;
+class LoadGenerator;
+class ExportJob;
+class SessionJournal;
 
 // 赞赏窗口类
 class AppreciationDialog : public QDialog {
@@ -51,54 +33,99 @@ public:
 class TimerDock : public QDockWidget {
     Q_OBJECT
 
+    // 基准测试直接调用私有槽（benchmarks/timer-benchmarks.cpp）
+    friend class TimerDockBenchmark;
+
 public:
     explicit TimerDock(QWidget *parent = nullptr);
     ~TimerDock();
 
+    // 会话日志的位置，在第一次显示之前设置；不设置则不记录会话
+    void setJournalPath(const QString &path) { journalPath = path; }
+    // 历史会话的归档目录；不设置则不归档
+    void setArchiveDirectory(const QString &path) { archiveDirectory = path; }
+
+protected:
+    void changeEvent(QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
 private:
+    // 第一次显示时创建计时线程和全部界面
+    void ensureContent();
     void setupUI();
     void updateAllTimes();
-    void updateTotalTime(int recordIndex);
-    void updateSegmentDisplay(int recordIndex, int segmentIndex);
-    void updateRecordDeleteButtonsVisibility();
-    void updateSegmentDeleteButtonsVisibility(int recordIndex);
+    void updateTotalTime(RecordId recordId, const TimeReading &reading);
+    void updateSegmentDisplay(RecordId recordId, SegmentId segmentId, const TimeReading &reading);
     void showErrorMessage(const QString &message);
     void hideErrorMessage();
     void onVisibilityChanged(bool visible);
-    QWidget *createRecordWidget(int index);
-    QWidget *createSegmentWidget(int recordIndex, int segmentIndex);
-    void removeRecordWidgets(int index);
-    void removeSegmentWidgets(int recordIndex, int segmentIndex);
-    bool isMinTimeReached(int recordIndex) const;
-    int getMinTime(int recordIndex) const;
-    QString formatTime(const QTime &time) const;
+    void setRecordExpanded(RecordId recordId, bool expanded);
+    void updateRecordsOfType(SpeakerType type);
+    void setMinTimeMinutes(SpeakerType type, int minutes);
+    int minTimeMinutes(SpeakerType type);
+    void rebuildTimeStyles();
+
+    // 批量修改：期间暂停界面更新，模型和视图在全部修改完成后只重新排列、绘制一次
+    template <typename Fn>
+    void runBatch(Fn fn);
+    void importAgenda();
+    void deleteFinishedRecords();
+    void resetSession();
+    // 删除所有记录并添加一条空记录，不询问、不归档
+    void clearSession();
+    // 从会话日志恢复上次崩溃前的记录，没有可恢复的记录时返回 false
+    bool restoreSession();
+    // 把当前会话写入归档目录，重置和关闭时调用
+    void archiveSession();
 
     // 新增导出函数
     void exportToText();
     void exportToExcel();
+    // 在工作线程上把当前模型的副本写入 filePath，同一时间只进行一个导出
+    void startExport(ExportFormat format, const QString &filePath);
+    // 统计归档目录中的全部历史会话，导出为工作簿
+    void exportHistory();
+    void runExportJob(ExportJob *job);
     void showAppreciation();
 
-    QVBoxLayout *recordsLayout;
-    QComboBox *speakerMinTimeCombo;
-    QComboBox *discussantMinTimeCombo;
-    QTimer *updateTimer;
-    QVector<RecordWidgets> records;
-    int customMinTimes[2] = {10, 5};  // 默认讲者10分钟，讨论嘉宾5分钟
+    QWidget *mainWidget = nullptr;
+    RecordListModel *recordModel = nullptr;
+    RecordListView *recordView = nullptr;
+    RecordRowDelegate *rowDelegate = nullptr;
+    QComboBox *speakerMinTimeCombo = nullptr;
+    QComboBox *discussantMinTimeCombo = nullptr;
+    TickScheduler *tickScheduler = nullptr;
+    ClickStamper *clickStamper = nullptr;
+    TimingStats timingStats;
+    DiagnosticsPanel *diagnosticsPanel = nullptr;
+    LoadGenerator *loadGenerator = nullptr;
+    std::unique_ptr<VirtualClock> virtualClock;  // 为空时使用单调时钟；必须比 service 活得久
+    QString journalPath;
+    QString archiveDirectory;
+    std::unique_ptr<SessionJournal> journal;  // 计时引擎持有它的指针，必须比 service 活得久
+    std::unique_ptr<TimerService> service;
+    ExportJob *exportJob = nullptr;  // 正在进行的导出
+    QProgressBar *exportProgress = nullptr;
 
     // 错误提示相关
-    QLabel *errorLabel;
-    QPropertyAnimation *fadeAnimation;
-    QTimer *errorTimer;
+    QLabel *errorLabel = nullptr;
+    QPropertyAnimation *fadeAnimation = nullptr;
+    QTimer *errorTimer = nullptr;
 
     static const int DEFAULT_SPEAKER_TIMES[];
     static const int DEFAULT_DISCUSSANT_TIMES[];
+    // 每种行控件预先创建并保留的空闲数量，可以用环境变量 SPEECH_TIMER_ROW_POOL 调整
+    static const int DEFAULT_ROW_POOL_SIZE = 16;
+    static const int MAX_ROW_POOL_SIZE = 1024;
 
 private Q_SLOTS:
     void onAddRecord();
-    void onDeleteRecord(int index);
-    void onAddSegment(int recordIndex);
-    void onDeleteSegment(int recordIndex, int segmentIndex);
-    void onStartSegment(int recordIndex, int segmentIndex);
-    void onEndSegment(int recordIndex, int segmentIndex);
+    void onDeleteRecord(RecordId recordId);
+    void onAddSegment(RecordId recordId);
+    void onDeleteSegment(RecordId recordId, SegmentId segmentId);
+    void onStartSegment(RecordId recordId, SegmentId segmentId, const ClickStamper::Stamp &stamp);
+    void onEndSegment(RecordId recordId, SegmentId segmentId, const ClickStamper::Stamp &stamp);
+    void onRecordTypeChanged(RecordId recordId, SpeakerType type);
+    void onRecordNameChanged(RecordId recordId, const QString &name);
     void onExportText() { exportToText(); }
 }; 
\ No newline at end of file
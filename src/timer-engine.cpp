@@ -0,0 +1,382 @@
+#include "timer-engine.hpp"
+#include "session-journal.hpp"
+
+#include <algorithm>
+
+TimerEngine::TimerEngine(const WallClockAnchor &anchor)
+    : head(NO_ID),
+      tail(NO_ID),
+      nextRecordId(1),
+      nextSegmentId(1),
+      anchor(anchor)
+{
+    minTimes[static_cast<int>(SpeakerType::Speaker)] = 10;
+    minTimes[static_cast<int>(SpeakerType::Discussant)] = 5;
+}
+
+const TimerRecord *TimerEngine::findRecord(RecordId id) const
+{
+    auto it = records.find(id);
+    return it == records.end() ? nullptr : &it->second;
+}
+
+const TimerSegment *TimerEngine::findSegment(SegmentId id) const
+{
+    auto it = segments.find(id);
+    return it == segments.end() ? nullptr : &it->second;
+}
+
+TimerRecord *TimerEngine::recordPtr(RecordId id)
+{
+    auto it = records.find(id);
+    return it == records.end() ? nullptr : &it->second;
+}
+
+TimerSegment *TimerEngine::segmentPtr(SegmentId id)
+{
+    auto it = segments.find(id);
+    return it == segments.end() ? nullptr : &it->second;
+}
+
+RecordId TimerEngine::nextRecord(RecordId id) const
+{
+    const TimerRecord *record = findRecord(id);
+    return record ? record->next : NO_ID;
+}
+
+RecordId TimerEngine::prevRecord(RecordId id) const
+{
+    const TimerRecord *record = findRecord(id);
+    return record ? record->prev : NO_ID;
+}
+
+RecordId TimerEngine::addRecord(SpeakerType type)
+{
+    RecordId id = nextRecordId++;
+    TimerRecord &record = records[id];
+    record.id = id;
+    record.type = type;
+
+    // 追加到显示顺序末尾
+    record.prev = tail;
+    if (tail != NO_ID) {
+        records[tail].next = id;
+    } else {
+        head = id;
+    }
+    tail = id;
+
+    if (journal.target) {
+        journal.target->recordAdded(*this, id, type);
+    }
+    return id;
+}
+
+void TimerEngine::removeRecord(RecordId id)
+{
+    TimerRecord *record = recordPtr(id);
+    if (!record) {
+        return;
+    }
+    // 堆中该记录的截止时间找不到记录，出堆时自然丢弃
+    if (record->isRunning()) {
+        removeRunning(id);
+    }
+    for (SegmentId segmentId : record->segments) {
+        segments.erase(segmentId);
+    }
+
+    // 从显示顺序中摘除
+    if (record->prev != NO_ID) {
+        records[record->prev].next = record->next;
+    } else {
+        head = record->next;
+    }
+    if (record->next != NO_ID) {
+        records[record->next].prev = record->prev;
+    } else {
+        tail = record->prev;
+    }
+    records.erase(id);
+
+    if (journal.target) {
+        journal.target->recordRemoved(*this, id);
+    }
+}
+
+void TimerEngine::setRecordName(RecordId id, const std::string &name)
+{
+    if (TimerRecord *record = recordPtr(id)) {
+        record->name = name;
+        if (journal.target) {
+            journal.target->recordRenamed(*this, id, name);
+        }
+    }
+}
+
+void TimerEngine::setRecordType(RecordId id, SpeakerType type)
+{
+    if (TimerRecord *record = recordPtr(id)) {
+        record->type = type;
+        // 从开始计时算起，已经过去的截止时间在下一次 advanceDeadlines 时立即触发
+        scheduleDeadline(*record, record->runningStartNs);
+        if (journal.target) {
+            journal.target->recordTypeChanged(*this, id, type);
+        }
+    }
+}
+
+TimerEngine::Result TimerEngine::addSegment(RecordId recordId, SegmentId *segmentId)
+{
+    TimerRecord *record = recordPtr(recordId);
+    if (!record) {
+        return Result::InvalidId;
+    }
+
+    // 有未使用的时段或正在计时的时段时不允许添加，新时段总是追加在最后，
+    // 所以只需要看最后一个时段
+    if (!record->segments.empty() && !segments[record->segments.back()].isStarted()) {
+        return Result::HasUnusedSegment;
+    }
+    if (record->isRunning()) {
+        return Result::HasRunningSegment;
+    }
+
+    SegmentId id = nextSegmentId++;
+    TimerSegment &segment = segments[id];
+    segment.id = id;
+    segment.recordId = recordId;
+    record->segments.push_back(id);
+
+    if (segmentId) {
+        *segmentId = id;
+    }
+    if (journal.target) {
+        journal.target->segmentAdded(*this, recordId, id);
+    }
+    return Result::Ok;
+}
+
+void TimerEngine::removeSegment(SegmentId id)
+{
+    TimerSegment *segment = segmentPtr(id);
+    if (!segment) {
+        return;
+    }
+    TimerRecord *record = recordPtr(segment->recordId);
+    if (record) {
+        // 已结束的时段从累计中减去
+        if (segment->isEnded()) {
+            record->closedNs -= segment->endNs - segment->startNs;
+        }
+        if (segment->isRunning) {
+            record->runningSegment = NO_ID;
+            record->runningStartNs = TIMER_NO_TIME;
+            removeRunning(record->id);
+            scheduleDeadline(*record, TIMER_NO_TIME);
+        }
+        auto &order = record->segments;
+        order.erase(std::find(order.begin(), order.end(), id));
+    }
+    segments.erase(id);
+
+    if (journal.target) {
+        journal.target->segmentRemoved(*this, id);
+    }
+}
+
+TimerEngine::Result TimerEngine::startSegment(SegmentId id, int64_t atNs, int64_t latencyNs)
+{
+    TimerSegment *segment = segmentPtr(id);
+    if (!segment) {
+        return Result::InvalidId;
+    }
+    TimerRecord *record = recordPtr(segment->recordId);
+    if (segment->isStarted()) {
+        return Result::AlreadyStarted;
+    }
+    if (record->isRunning()) {
+        return Result::HasRunningSegment;
+    }
+
+    segment->startNs = atNs;
+    segment->startLatencyNs = latencyNs;
+    segment->isRunning = true;
+    record->runningSegment = id;
+    record->runningStartNs = atNs;
+    running.push_back(record->id);
+    scheduleDeadline(*record, atNs);
+    if (journal.target) {
+        journal.target->segmentStarted(*this, id, atNs, latencyNs);
+    }
+    return Result::Ok;
+}
+
+TimerEngine::Result TimerEngine::endSegment(SegmentId id, int64_t atNs, int64_t latencyNs)
+{
+    TimerSegment *segment = segmentPtr(id);
+    if (!segment) {
+        return Result::InvalidId;
+    }
+    if (!segment->isRunning) {
+        return Result::NotRunning;
+    }
+    TimerRecord *record = recordPtr(segment->recordId);
+
+    // 两次点击的时间戳来自事件，保证结束不早于开始
+    segment->endNs = std::max(atNs, segment->startNs);
+    segment->endLatencyNs = latencyNs;
+    segment->isRunning = false;
+    record->closedNs += segment->endNs - segment->startNs;
+    record->runningSegment = NO_ID;
+    record->runningStartNs = TIMER_NO_TIME;
+    removeRunning(record->id);
+    scheduleDeadline(*record, TIMER_NO_TIME);
+    if (journal.target) {
+        journal.target->segmentEnded(*this, id, segment->endNs, latencyNs);
+    }
+    return Result::Ok;
+}
+
+void TimerEngine::removeRunning(RecordId id)
+{
+    // 顺序无关，与末尾交换后删除
+    auto it = std::find(running.begin(), running.end(), id);
+    if (it != running.end()) {
+        *it = running.back();
+        running.pop_back();
+    }
+}
+
+int64_t TimerEngine::totalNs(RecordId id, int64_t nowNs) const
+{
+    const TimerRecord *record = findRecord(id);
+    return record ? record->totalNsAt(nowNs) : 0;
+}
+
+int TimerEngine::minTimeMinutes(SpeakerType type) const
+{
+    return minTimes[static_cast<int>(type)];
+}
+
+void TimerEngine::setMinTimeMinutes(SpeakerType type, int minutes)
+{
+    if (minTimes[static_cast<int>(type)] == minutes) {
+        return;
+    }
+    minTimes[static_cast<int>(type)] = minutes;
+
+    // 只有该类型正在计时的记录需要重新安排
+    for (RecordId id : running) {
+        TimerRecord &record = records[id];
+        if (record.type == type) {
+            scheduleDeadline(record, record.runningStartNs);
+        }
+    }
+}
+
+int64_t TimerEngine::minTimeNs(RecordId id) const
+{
+    const TimerRecord *record = findRecord(id);
+    return record ? minTimeMinutes(record->type) * NS_PER_MIN : 0;
+}
+
+bool TimerEngine::isMinTimeReached(RecordId id, int64_t nowNs) const
+{
+    const TimerRecord *record = findRecord(id);
+    return record && record->totalNsAt(nowNs) >= minTimeNs(id);
+}
+
+TimeState TimerEngine::totalState(RecordId id, int64_t nowNs) const
+{
+    return stateFor(totalNs(id, nowNs), minTimeNs(id));
+}
+
+TimeState TimerEngine::segmentState(SegmentId id, int64_t nowNs) const
+{
+    const TimerSegment *segment = findSegment(id);
+    if (!segment) {
+        return TimeState::Zero;
+    }
+    return stateFor(segment->durationNs(nowNs), minTimeNs(segment->recordId));
+}
+
+int64_t TimerEngine::nextStateChangeNs(RecordId id, int64_t nowNs) const
+{
+    const TimerRecord *record = findRecord(id);
+    if (!record || !record->isRunning()) {
+        return TIMER_NO_TIME;
+    }
+
+    // 时段和总计都从 runningStartNs 起匀速增长，分别在跨过 1 秒和最低时间时改变状态
+    const int64_t bounds[] = {NS_PER_SEC, minTimeNs(id)};
+    const int64_t bases[] = {0, record->closedNs};
+    int64_t next = TIMER_NO_TIME;
+    for (int64_t base : bases) {
+        for (int64_t bound : bounds) {
+            int64_t at = record->runningStartNs + (bound - base);
+            if (at > nowNs && (next == TIMER_NO_TIME || at < next)) {
+                next = at;
+            }
+        }
+    }
+    return next;
+}
+
+void TimerEngine::scheduleDeadline(TimerRecord &record, int64_t nowNs)
+{
+    // 旧的截止时间留在堆里，出堆时按 generation 判断失效
+    ++record.deadlineGeneration;
+    if (!record.isRunning()) {
+        return;
+    }
+
+    int64_t atNs = nextStateChangeNs(record.id, nowNs);
+    if (atNs == TIMER_NO_TIME) {
+        return;
+    }
+    deadlines.push_back(Deadline{atNs, record.id, record.deadlineGeneration});
+    std::push_heap(deadlines.begin(), deadlines.end());
+
+    // 频繁改类型或最低时间会留下大量失效项，超过有效项的数倍时重建
+    if (deadlines.size() > 4 * running.size() + 64) {
+        compactDeadlines();
+    }
+}
+
+void TimerEngine::compactDeadlines()
+{
+    auto stale = [this](const Deadline &deadline) {
+        const TimerRecord *record = findRecord(deadline.recordId);
+        return !record || record->deadlineGeneration != deadline.generation;
+    };
+    deadlines.erase(std::remove_if(deadlines.begin(), deadlines.end(), stale), deadlines.end());
+    std::make_heap(deadlines.begin(), deadlines.end());
+}
+
+void TimerEngine::advanceDeadlines(int64_t nowNs, std::vector<RecordId> *fired)
+{
+    while (!deadlines.empty() && deadlines.front().atNs <= nowNs) {
+        Deadline deadline = deadlines.front();
+        std::pop_heap(deadlines.begin(), deadlines.end());
+        deadlines.pop_back();
+
+        TimerRecord *record = recordPtr(deadline.recordId);
+        if (!record || record->deadlineGeneration != deadline.generation) {
+            continue;
+        }
+        if (fired) {
+            fired->push_back(record->id);
+        }
+        scheduleDeadline(*record, nowNs);
+    }
+}
+
+TimeState TimerEngine::stateFor(int64_t ns, int64_t minNs) const
+{
+    // 显示为 00:00 的时长按未计时处理
+    if (ns < NS_PER_SEC) {
+        return TimeState::Zero;
+    }
+    return ns >= minNs ? TimeState::Reached : TimeState::BelowMinimum;
+}
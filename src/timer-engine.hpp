@@ -0,0 +1,125 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "timer-record.hpp"
+
+class SessionJournal;
+
+// 计时状态，决定标签的配色
+enum class TimeState {
+    Zero,          // 尚未计时
+    BelowMinimum,  // 未达到最低时间
+    Reached        // 已达到最低时间
+};
+
+// 演讲计时的数据模型与全部计时逻辑，不依赖 Qt 和 libobs。
+// 记录和时段都用稳定 ID 寻址，通过哈希表查找，增删都是 O(1)。
+// 所有时间参数都是 timer-clock.hpp 中的单调时钟读数，由调用方传入，
+// 同一次刷新中的所有计算使用同一时刻。
+class TimerEngine {
+public:
+    enum class Result {
+        Ok,
+        InvalidId,
+        HasUnusedSegment,   // 还有未使用的时段
+        HasRunningSegment,  // 还有正在计时的时段
+        AlreadyStarted,
+        NotRunning
+    };
+
+    // anchor 把计时所用时钟的读数换算为墙上时间，只用于显示和导出
+    explicit TimerEngine(const WallClockAnchor &anchor = WallClockAnchor());
+
+    int recordCount() const { return static_cast<int>(records.size()); }
+    const TimerRecord *findRecord(RecordId id) const;
+    const TimerSegment *findSegment(SegmentId id) const;
+
+    // 按显示顺序遍历记录
+    RecordId firstRecord() const { return head; }
+    RecordId lastRecord() const { return tail; }
+    RecordId nextRecord(RecordId id) const;
+    RecordId prevRecord(RecordId id) const;
+
+    RecordId addRecord(SpeakerType type);
+    void removeRecord(RecordId id);
+    void setRecordName(RecordId id, const std::string &name);
+    void setRecordType(RecordId id, SpeakerType type);
+
+    Result addSegment(RecordId recordId, SegmentId *segmentId = nullptr);
+    void removeSegment(SegmentId id);
+    // atNs 是用户操作的时刻，latencyNs 是从操作到提交的延迟，仅作记录
+    Result startSegment(SegmentId id, int64_t atNs, int64_t latencyNs = 0);
+    Result endSegment(SegmentId id, int64_t atNs, int64_t latencyNs = 0);
+
+    // 有正在计时的时段的记录，刷新只需要处理这些
+    const std::vector<RecordId> &runningRecords() const { return running; }
+    bool hasRunningSegments() const { return !running.empty(); }
+    int64_t totalNs(RecordId id, int64_t nowNs) const;
+
+    // 最低时间（分钟），按角色设置
+    int minTimeMinutes(SpeakerType type) const;
+    void setMinTimeMinutes(SpeakerType type, int minutes);
+    int64_t minTimeNs(RecordId id) const;
+    bool isMinTimeReached(RecordId id, int64_t nowNs) const;
+    TimeState totalState(RecordId id, int64_t nowNs) const;
+    TimeState segmentState(SegmentId id, int64_t nowNs) const;
+    // 记录的总计或正在计时的时段在 nowNs 之后下一次改变状态的时刻，
+    // 没有在计时则为 TIMER_NO_TIME
+    int64_t nextStateChangeNs(RecordId id, int64_t nowNs) const;
+
+    // 所有正在计时的记录的下一次状态变化都作为绝对截止时间放在最小堆里，
+    // 开始/结束/删除、改类型和改最低时间时只重新安排受影响的记录。
+    // 两次截止时间之间不需要做任何检查。
+    // 最早的截止时间，没有则为 TIMER_NO_TIME（可能是已失效的项，提前醒来无害）
+    int64_t nextDeadlineNs() const { return deadlines.empty() ? TIMER_NO_TIME : deadlines.front().atNs; }
+    // 取出所有不晚于 nowNs 的截止时间，把状态发生变化的记录追加到 fired，并安排它们的下一次截止时间
+    void advanceDeadlines(int64_t nowNs, std::vector<RecordId> *fired = nullptr);
+
+    const WallClockAnchor &wallAnchor() const { return anchor; }
+
+    // 每次修改完成后通知会话日志，为空则不记录。引擎的副本不带日志
+    void setJournal(SessionJournal *value) { journal.target = value; }
+
+private:
+    // 会话日志直接读写内部状态来保存和恢复快照
+    friend class SessionJournal;
+
+    // 复制引擎时不复制日志，导出等使用的副本不会写日志
+    struct JournalLink {
+        SessionJournal *target;
+
+        JournalLink() : target(nullptr) {}
+        JournalLink(const JournalLink &) : target(nullptr) {}
+        JournalLink &operator=(const JournalLink &) { target = nullptr; return *this; }
+    };
+
+    TimerRecord *recordPtr(RecordId id);
+    TimerSegment *segmentPtr(SegmentId id);
+    void removeRunning(RecordId id);
+    TimeState stateFor(int64_t ns, int64_t minNs) const;
+    void scheduleDeadline(TimerRecord &record, int64_t nowNs);
+    void compactDeadlines();
+
+    struct Deadline {
+        int64_t atNs;
+        RecordId recordId;
+        uint32_t generation;  // 与记录当前的 deadlineGeneration 不同则已失效
+
+        // 用于 std::push_heap 等构造最小堆
+        bool operator<(const Deadline &other) const { return atNs > other.atNs; }
+    };
+
+    std::unordered_map<RecordId, TimerRecord> records;
+    std::unordered_map<SegmentId, TimerSegment> segments;
+    std::vector<RecordId> running;
+    std::vector<Deadline> deadlines;  // 最小堆，堆顶最早
+    RecordId head;
+    RecordId tail;
+    RecordId nextRecordId;
+    SegmentId nextSegmentId;
+    int minTimes[2];  // 分钟，下标为 SpeakerType
+    WallClockAnchor anchor;
+    JournalLink journal;
+};
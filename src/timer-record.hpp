@@ -1,40 +1,68 @@
 #pragma once
 
-#include <QDateTime>
-#include <QString>
-#include <QTime>
+#include <cstdint>
+#include <string>
 #include <vector>
+#include "timer-clock.hpp"
 
-#ifdef _WIN32
-#ifdef EXPORT_LIB
-#define EXPORT __declspec(dllexport)
-#else
-#define EXPORT __declspec(dllimport)
-#endif
-#else
-#define EXPORT
-#endif
-
-enum class EXPORT SpeakerType {
+// 记录和时段的稳定 ID，创建后不变、不复用，删除其他项不会影响它
+typedef uint32_t RecordId;
+typedef uint32_t SegmentId;
+const uint32_t NO_ID = 0;
+
+enum class SpeakerType {
     Speaker,
     Discussant
 };
 
-struct EXPORT TimerSegment {
-    QTime startTime;
-    QTime endTime;
+struct TimerSegment {
+    SegmentId id;
+    RecordId recordId;  // 所属记录
+    int64_t startNs;    // 单调时钟读数，见 timer-clock.hpp
+    int64_t endNs;
+    int64_t startLatencyNs;  // 从点击到提交开始/结束时间的延迟
+    int64_t endLatencyNs;
     bool isRunning;
 
-    TimerSegment() : isRunning(false) {}
+    TimerSegment() : id(NO_ID), recordId(NO_ID), startNs(TIMER_NO_TIME), endNs(TIMER_NO_TIME),
+                     startLatencyNs(0), endLatencyNs(0), isRunning(false) {}
+
+    bool isStarted() const { return startNs != TIMER_NO_TIME; }
+    bool isEnded() const { return endNs != TIMER_NO_TIME; }
+
+    // 未结束的时段按 nowNs 计算
+    int64_t durationNs(int64_t nowNs) const
+    {
+        if (!isStarted()) {
+            return 0;
+        }
+        return (isEnded() ? endNs : nowNs) - startNs;
+    }
 };
 
-struct EXPORT TimerRecord {
-    QString name;
+struct TimerRecord {
+    RecordId id;
+    std::string name;          // UTF-8
     SpeakerType type;
-    QTime totalTime;
-    bool isRunning;
-    bool isExpanded;
-    std::vector<TimerSegment> segments;
+    int64_t closedNs;          // 已结束时段的累计时长，在结束/删除时段时增量维护
+    SegmentId runningSegment;  // 正在计时的时段，没有则为 NO_ID
+    int64_t runningStartNs;    // 正在计时的时段的开始时间
+    std::vector<SegmentId> segments;  // 按显示顺序
+    RecordId prev;             // 显示顺序的双向链表，删除为 O(1)
+    RecordId next;
+    uint32_t deadlineGeneration;  // 每次重新安排阈值截止时间时递增，旧的截止时间随之失效
 
-    TimerRecord() : type(SpeakerType::Speaker), isRunning(false), isExpanded(true) {}
-}; 
\ No newline at end of file
+    TimerRecord() : id(NO_ID), type(SpeakerType::Speaker), closedNs(0), runningSegment(NO_ID),
+                    runningStartNs(TIMER_NO_TIME), prev(NO_ID), next(NO_ID), deadlineGeneration(0) {}
+
+    bool isRunning() const { return runningSegment != NO_ID; }
+
+    // O(1)：已结束时段之和加上唯一正在计时的时段
+    int64_t totalNsAt(int64_t nowNs) const
+    {
+        if (!isRunning()) {
+            return closedNs;
+        }
+        return closedNs + (nowNs - runningStartNs);
+    }
+};
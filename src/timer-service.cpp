@@ -0,0 +1,153 @@
+#include "timer-service.hpp"
+
+static std::chrono::steady_clock::time_point toTimePoint(int64_t ns)
+{
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+TimerService::TimerService(TimerClock &clock)
+    : clock(clock),
+      engine(WallClockAnchor(clock.nowNs())),
+      anchor(engine.wallAnchor()),
+      sequence(0),
+      queued(0),
+      completed(0),
+      stopping(false)
+{
+    // 先发布一份空快照，读方在任何时候都能读到有效数据
+    publish(clock.nowNs());
+    thread = std::thread(&TimerService::run, this);
+}
+
+TimerService::~TimerService()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+void TimerService::clockChanged()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    wake.notify_all();
+}
+
+void TimerService::execute(const std::function<void(TimerEngine &)> &task)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t ticket = ++queued;
+    tasks.push_back(&task);
+    wake.notify_all();
+
+    // 任务按提交顺序执行，完成数追上自己的序号即已执行完毕
+    done.wait(lock, [this, ticket]() { return completed >= ticket; });
+}
+
+TimerEngine::Result TimerService::startSegment(SegmentId id, int64_t atNs, int64_t latencyNs)
+{
+    return call([id, atNs, latencyNs](TimerEngine &e) { return e.startSegment(id, atNs, latencyNs); });
+}
+
+SegmentEnd TimerService::endSegment(SegmentId id, int64_t atNs, int64_t latencyNs)
+{
+    return call([this, id, atNs, latencyNs](TimerEngine &e) {
+        SegmentEnd ended = {e.endSegment(id, atNs, latencyNs), TIMER_NO_TIME,
+                            {0, TimeState::Zero}, {0, TimeState::Zero}};
+        if (ended.result != TimerEngine::Result::Ok) {
+            return ended;
+        }
+        int64_t nowNs = clock.nowNs();
+        const TimerSegment *segment = e.findSegment(id);
+        ended.endNs = segment->endNs;
+        ended.segment = TimeReading{segment->durationNs(nowNs), e.segmentState(id, nowNs)};
+        ended.total = TimeReading{e.totalNs(segment->recordId, nowNs), e.totalState(segment->recordId, nowNs)};
+        return ended;
+    });
+}
+
+TimeReading TimerService::recordTime(RecordId id)
+{
+    return call([this, id](TimerEngine &e) {
+        int64_t nowNs = clock.nowNs();
+        return TimeReading{e.totalNs(id, nowNs), e.totalState(id, nowNs)};
+    });
+}
+
+TimeReading TimerService::segmentTime(SegmentId id)
+{
+    return call([this, id](TimerEngine &e) {
+        int64_t nowNs = clock.nowNs();
+        const TimerSegment *segment = e.findSegment(id);
+        return TimeReading{segment ? segment->durationNs(nowNs) : 0, e.segmentState(id, nowNs)};
+    });
+}
+
+void TimerService::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        // 截止时间只会被计时线程自己修改，这里读取是安全的
+        int64_t deadlineNs = engine.nextDeadlineNs();
+        if (tasks.empty()) {
+            // 截止时间是时钟读数，换算为单调时钟上的等待；暂停的虚拟时钟只能由 clockChanged() 唤醒
+            int64_t wakeNs = deadlineNs == TIMER_NO_TIME ? TIMER_NO_TIME : clock.steadyNsAt(deadlineNs);
+            if (wakeNs == TIMER_NO_TIME) {
+                wake.wait(lock);
+            } else {
+                wake.wait_until(lock, toTimePoint(wakeNs));
+            }
+            if (stopping) {
+                break;
+            }
+        }
+
+        const std::function<void(TimerEngine &)> *task = nullptr;
+        if (!tasks.empty()) {
+            task = tasks.front();
+            tasks.pop_front();
+        } else if (deadlineNs == TIMER_NO_TIME || clock.nowNs() < deadlineNs) {
+            continue;  // 虚假唤醒，或时钟被调整
+        }
+
+        lock.unlock();
+        if (task) {
+            (*task)(engine);
+        }
+        // 每次修改后、以及有记录跨过阈值时重新发布；两次之间计时线程完全休眠
+        int64_t nowNs = clock.nowNs();
+        engine.advanceDeadlines(nowNs);
+        publish(nowNs);
+        lock.lock();
+
+        if (task) {
+            ++completed;
+            done.notify_all();
+        }
+    }
+}
+
+void TimerService::publish(int64_t nowNs)
+{
+    // 复用上上次快照的容量，稳定运行时不分配内存
+    TimerSnapshot &snapshot = snapshots.writeBuffer();
+    snapshot.sequence = ++sequence;
+    snapshot.atNs = nowNs;
+    snapshot.running.clear();
+
+    for (RecordId id : engine.runningRecords()) {
+        const TimerRecord &record = *engine.findRecord(id);
+        RunningTime entry;
+        entry.recordId = id;
+        entry.segmentId = record.runningSegment;
+        entry.startNs = record.runningStartNs;
+        entry.closedNs = record.closedNs;
+        entry.segmentState = engine.segmentState(record.runningSegment, nowNs);
+        entry.totalState = engine.totalState(id, nowNs);
+        snapshot.running.push_back(entry);
+    }
+    snapshots.publish();
+}
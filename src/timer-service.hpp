@@ -0,0 +1,119 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "timer-engine.hpp"
+#include "triple-buffer.hpp"
+
+// 一条正在计时的记录。时长随时间线性增长，读方按自己的时刻推算，
+// 状态由计时线程在跨过阈值时重新发布
+struct RunningTime {
+    RecordId recordId;
+    SegmentId segmentId;
+    int64_t startNs;   // 正在计时的时段的开始时间
+    int64_t closedNs;  // 已结束时段的累计时长
+    TimeState segmentState;
+    TimeState totalState;
+
+    int64_t segmentNsAt(int64_t nowNs) const { return nowNs - startNs; }
+    int64_t totalNsAt(int64_t nowNs) const { return closedNs + (nowNs - startNs); }
+};
+
+// 计时线程发布的只读快照，每次提交和每次状态变化后整体替换
+struct TimerSnapshot {
+    uint64_t sequence;  // 发布序号，0 表示还没有发布过
+    int64_t atNs;       // 状态的计算时刻
+    std::vector<RunningTime> running;
+
+    TimerSnapshot() : sequence(0), atNs(TIMER_NO_TIME) {}
+};
+
+struct TimeReading {
+    int64_t ns;
+    TimeState state;
+};
+
+// 结束时段的结果，连同结束后界面要显示的读数一起取回，不必再逐项查询
+struct SegmentEnd {
+    TimerEngine::Result result;
+    int64_t endNs;        // 计时线程记录的结束时间，可能被修正为不早于开始时间
+    TimeReading segment;  // 结束后的时段时长
+    TimeReading total;    // 所属记录的累计时长
+};
+
+// 独立的计时线程：TimerEngine 只在这个线程上访问，开始/结束提交、
+// 累计与最低时间判断都在这里完成，界面线程卡顿不会推迟或扭曲计时。
+//
+// 界面线程通过 call() 提交修改和查询，计时线程只做很短的工作，调用方
+// 等待的时间是微秒级的；刷新显示只读 snapshot()，不加锁也不等待。
+// 计时线程从不等待界面线程，call() 不能在计时线程上调用。
+//
+// 所有"当前时刻"都从构造时传入的 TimerClock 读取，界面推算显示时也应使用 nowNs()。
+class TimerService {
+public:
+    explicit TimerService(TimerClock &clock = steadyClock());
+    ~TimerService();
+
+    TimerService(const TimerService &) = delete;
+    TimerService &operator=(const TimerService &) = delete;
+
+    // 在计时线程上执行 fn(engine) 并返回其结果，返回前已发布新的快照
+    template <typename F>
+    auto call(F fn) -> decltype(fn(std::declval<TimerEngine &>()));
+
+    // 提交用户操作的时刻，见 TimerEngine::startSegment
+    TimerEngine::Result startSegment(SegmentId id, int64_t atNs, int64_t latencyNs);
+    // 只有 result 为 Ok 时其余字段才有意义
+    SegmentEnd endSegment(SegmentId id, int64_t atNs, int64_t latencyNs);
+
+    // 按计时线程当前时刻计算的时长和状态
+    TimeReading recordTime(RecordId id);
+    TimeReading segmentTime(SegmentId id);
+
+    // 最近一次发布的快照。只能由同一个读方线程调用，
+    // 返回的引用在下一次调用之前有效
+    const TimerSnapshot &snapshot() { return snapshots.read(); }
+    bool hasRunningSegments() { return !snapshot().running.empty(); }
+
+    // 构造后不再改变，任何线程都可以读
+    const WallClockAnchor &wallAnchor() const { return anchor; }
+    TimerClock &timerClock() const { return clock; }
+    int64_t nowNs() const { return clock.nowNs(); }
+    // 时钟被暂停、调速或推进后调用，计时线程按新的读数重新安排等待
+    void clockChanged();
+
+private:
+    void execute(const std::function<void(TimerEngine &)> &task);
+    void run();
+    void publish(int64_t nowNs);
+
+    TimerClock &clock;
+    TimerEngine engine;  // 只在计时线程上访问
+    const WallClockAnchor anchor;
+    TripleBuffer<TimerSnapshot> snapshots;
+    uint64_t sequence;  // 计时线程独占
+
+    std::mutex mutex;
+    std::condition_variable wake;  // 有新任务或需要退出
+    std::condition_variable done;  // 有任务执行完毕
+    std::deque<const std::function<void(TimerEngine &)> *> tasks;
+    uint64_t queued;
+    uint64_t completed;
+    bool stopping;
+    std::thread thread;
+};
+
+template <typename F>
+auto TimerService::call(F fn) -> decltype(fn(std::declval<TimerEngine &>()))
+{
+    typedef decltype(fn(std::declval<TimerEngine &>())) R;
+    std::packaged_task<R(TimerEngine &)> task(std::move(fn));
+    std::future<R> result = task.get_future();
+    execute([&task](TimerEngine &target) { task(target); });
+    return result.get();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+
+// 单写单读的无锁三缓冲：写方在后台缓冲区写好后整体发布，
+// 读方总是拿到最近一次发布的完整数据。双方都只做一次原子交换，
+// 互不等待，写得再快也不会让读方读到写了一半的数据。
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), back(2), front(0) {}
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // 仅写方线程调用。返回的缓冲区保留上上次写入的内容，可以复用其容量
+    T &writeBuffer() { return slots[back]; }
+
+    void publish()
+    {
+        back = middle.exchange(back | DIRTY, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // 仅读方线程调用。返回的引用在下一次调用 read() 之前有效
+    const T &read()
+    {
+        if (middle.load(std::memory_order_relaxed) & DIRTY) {
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        }
+        return slots[front];
+    }
+
+private:
+    static const int INDEX = 3;
+    static const int DIRTY = 4;  // 中间缓冲区有读方还没取走的新数据
+
+    T slots[3];
+    std::atomic<int> middle;
+    int back;   // 写方独占
+    int front;  // 读方独占
+};
@@ -0,0 +1,387 @@
+#include "xlsx-writer.hpp"
+#include <locale>
+#include <zlib.h>
+
+namespace {
+
+const char XML_HEADER[] = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n";
+const char MAIN_NS[] = "http://schemas.openxmlformats.org/spreadsheetml/2006/main";
+const char REL_NS[] = "http://schemas.openxmlformats.org/officeDocument/2006/relationships";
+
+const char CONTENT_TYPES[] =
+    "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+    "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+    "<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+    "<Override PartName=\"/xl/workbook.xml\" "
+    "ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>"
+    "<Override PartName=\"/xl/worksheets/sheet1.xml\" "
+    "ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>"
+    "<Override PartName=\"/xl/styles.xml\" "
+    "ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml\"/>"
+    "<Override PartName=\"/xl/sharedStrings.xml\" "
+    "ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml\"/>"
+    "</Types>";
+
+const char PACKAGE_RELS[] =
+    "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+    "<Relationship Id=\"rId1\" "
+    "Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument\" "
+    "Target=\"xl/workbook.xml\"/>"
+    "</Relationships>";
+
+const char WORKBOOK_RELS[] =
+    "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+    "<Relationship Id=\"rId1\" "
+    "Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" "
+    "Target=\"worksheets/sheet1.xml\"/>"
+    "<Relationship Id=\"rId2\" "
+    "Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles\" "
+    "Target=\"styles.xml\"/>"
+    "<Relationship Id=\"rId3\" "
+    "Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/sharedStrings\" "
+    "Target=\"sharedStrings.xml\"/>"
+    "</Relationships>";
+
+// cellXfs 的顺序与 XlsxWriter::CellStyle 一致
+const char STYLES[] =
+    "<numFmts count=\"2\">"
+    "<numFmt numFmtId=\"164\" formatCode=\"hh:mm:ss\"/>"
+    "<numFmt numFmtId=\"165\" formatCode=\"[mm]:ss\"/>"
+    "</numFmts>"
+    "<fonts count=\"2\">"
+    "<font><sz val=\"11\"/><name val=\"Calibri\"/></font>"
+    "<font><b/><sz val=\"11\"/><name val=\"Calibri\"/></font>"
+    "</fonts>"
+    "<fills count=\"2\">"
+    "<fill><patternFill patternType=\"none\"/></fill>"
+    "<fill><patternFill patternType=\"gray125\"/></fill>"
+    "</fills>"
+    "<borders count=\"1\"><border><left/><right/><top/><bottom/><diagonal/></border></borders>"
+    "<cellStyleXfs count=\"1\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\"/></cellStyleXfs>"
+    "<cellXfs count=\"4\">"
+    "<xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\"/>"
+    "<xf numFmtId=\"0\" fontId=\"1\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyFont=\"1\"/>"
+    "<xf numFmtId=\"164\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyNumberFormat=\"1\"/>"
+    "<xf numFmtId=\"165\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyNumberFormat=\"1\"/>"
+    "</cellXfs>"
+    "<cellStyles count=\"1\"><cellStyle name=\"Normal\" xfId=\"0\" builtinId=\"0\"/></cellStyles>";
+
+// zip 中所有条目使用同一个时间 1980-01-01 00:00，同样的内容总是生成同样的文件
+const uint16_t DOS_TIME = 0;
+const uint16_t DOS_DATE = (0 << 9) | (1 << 5) | 1;
+// 第 3 位：大小和 CRC 在数据之后的数据描述符中给出
+const uint16_t ZIP_FLAGS = 0x0008;
+const uint16_t ZIP_VERSION = 20;
+
+void put16(std::string &out, uint16_t value)
+{
+    out += static_cast<char>(value & 0xff);
+    out += static_cast<char>(value >> 8);
+}
+
+void put32(std::string &out, uint32_t value)
+{
+    put16(out, static_cast<uint16_t>(value & 0xffff));
+    put16(out, static_cast<uint16_t>(value >> 16));
+}
+
+void appendEscaped(std::string &out, const std::string &text)
+{
+    for (char c : text) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        default:
+            // XML 1.0 不允许制表符、换行以外的控制字符
+            if (static_cast<unsigned char>(c) >= 0x20 || c == '\t' || c == '\n' || c == '\r') {
+                out += c;
+            }
+        }
+    }
+}
+
+void appendColumnName(std::string &out, uint32_t column)
+{
+    char letters[8];
+    int count = 0;
+    for (uint32_t n = column + 1; n > 0; n = (n - 1) / 26) {
+        letters[count++] = static_cast<char>('A' + (n - 1) % 26);
+    }
+    while (count > 0) {
+        out += letters[--count];
+    }
+}
+
+}  // namespace
+
+XlsxWriter::XlsxWriter(Sink sink, const std::string &sheetName, const std::vector<double> &columnWidths)
+    : sink(std::move(sink)),
+      good(true),
+      finished(false),
+      offset(0),
+      current(),
+      zstream(new z_stream_s()),
+      deflateBuffer(BUFFER_SIZE),
+      row(0),
+      column(0),
+      sharedRefs(0)
+{
+    number.imbue(std::locale::classic());
+    number.precision(17);
+
+    // 原始 deflate 流（不带 zlib 头），zip 条目要求的格式
+    if (deflateInit2(zstream.get(), Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        good = false;
+        return;
+    }
+    xml.reserve(BUFFER_SIZE + 1024);
+
+    writeEntry("[Content_Types].xml", std::string(XML_HEADER) + CONTENT_TYPES);
+    writeEntry("_rels/.rels", std::string(XML_HEADER) + PACKAGE_RELS);
+    writeEntry("xl/_rels/workbook.xml.rels", std::string(XML_HEADER) + WORKBOOK_RELS);
+    writeEntry("xl/styles.xml", std::string(XML_HEADER) + "<styleSheet xmlns=\"" + MAIN_NS + "\">" + STYLES +
+                                    "</styleSheet>");
+
+    std::string workbook = std::string(XML_HEADER) + "<workbook xmlns=\"" + MAIN_NS + "\" xmlns:r=\"" + REL_NS +
+                           "\"><sheets><sheet name=\"";
+    appendEscaped(workbook, sheetName);
+    workbook += "\" sheetId=\"1\" r:id=\"rId1\"/></sheets></workbook>";
+    writeEntry("xl/workbook.xml", workbook);
+
+    // 工作表一直打开到 finish()，行数据边生成边压缩
+    beginEntry("xl/worksheets/sheet1.xml");
+    xml += XML_HEADER;
+    xml += "<worksheet xmlns=\"";
+    xml += MAIN_NS;
+    xml += "\">";
+    if (!columnWidths.empty()) {
+        xml += "<cols>";
+        for (size_t i = 0; i < columnWidths.size(); ++i) {
+            number.str(std::string());
+            number << columnWidths[i];
+            std::string index = std::to_string(i + 1);
+            xml += "<col min=\"" + index + "\" max=\"" + index + "\" width=\"" + number.str() +
+                   "\" customWidth=\"1\"/>";
+        }
+        xml += "</cols>";
+    }
+    xml += "<sheetData>";
+}
+
+XlsxWriter::~XlsxWriter()
+{
+    deflateEnd(zstream.get());
+}
+
+void XlsxWriter::beginRow()
+{
+    ++row;
+    column = 0;
+    xml += "<row r=\"" + std::to_string(row) + "\">";
+}
+
+void XlsxWriter::addString(const std::string &utf8, CellStyle style)
+{
+    auto it = sharedIndex.find(utf8);
+    if (it == sharedIndex.end()) {
+        it = sharedIndex.emplace(utf8, static_cast<uint32_t>(sharedStrings.size())).first;
+        sharedStrings.push_back(&it->first);
+    }
+    ++sharedRefs;
+
+    beginCell(style);
+    xml += " t=\"s\"><v>";
+    xml += std::to_string(it->second);
+    xml += "</v></c>";
+}
+
+void XlsxWriter::addNumber(double value, CellStyle style)
+{
+    number.str(std::string());
+    number << value;
+
+    beginCell(style);
+    xml += "><v>";
+    xml += number.str();
+    xml += "</v></c>";
+}
+
+void XlsxWriter::endRow()
+{
+    xml += "</row>";
+    flushXml(false);
+}
+
+bool XlsxWriter::finish()
+{
+    if (finished) {
+        return good;
+    }
+    finished = true;
+
+    xml += "</sheetData></worksheet>";
+    flushXml(true);
+    endEntry();
+
+    // 共享字符串表同样分块压缩写出
+    beginEntry("xl/sharedStrings.xml");
+    xml += XML_HEADER;
+    xml += "<sst xmlns=\"";
+    xml += MAIN_NS;
+    xml += "\" count=\"" + std::to_string(sharedRefs) + "\" uniqueCount=\"" +
+           std::to_string(sharedStrings.size()) + "\">";
+    for (const std::string *text : sharedStrings) {
+        xml += "<si><t xml:space=\"preserve\">";
+        appendEscaped(xml, *text);
+        xml += "</t></si>";
+        flushXml(false);
+    }
+    xml += "</sst>";
+    flushXml(true);
+    endEntry();
+
+    // 中央目录
+    uint64_t directoryOffset = offset;
+    std::string directory;
+    for (const Entry &entry : entries) {
+        put32(directory, 0x02014b50);
+        put16(directory, ZIP_VERSION);  // 创建者版本
+        put16(directory, ZIP_VERSION);  // 解压所需版本
+        put16(directory, ZIP_FLAGS);
+        put16(directory, Z_DEFLATED);
+        put16(directory, DOS_TIME);
+        put16(directory, DOS_DATE);
+        put32(directory, entry.crc);
+        put32(directory, entry.compressedSize);
+        put32(directory, entry.size);
+        put16(directory, static_cast<uint16_t>(entry.name.size()));
+        put16(directory, 0);  // 扩展字段长度
+        put16(directory, 0);  // 注释长度
+        put16(directory, 0);  // 起始磁盘号
+        put16(directory, 0);  // 内部属性
+        put32(directory, 0);  // 外部属性
+        put32(directory, entry.offset);
+        directory += entry.name;
+    }
+    output(directory.data(), directory.size());
+
+    std::string end;
+    put32(end, 0x06054b50);
+    put16(end, 0);  // 磁盘号
+    put16(end, 0);  // 中央目录所在磁盘
+    put16(end, static_cast<uint16_t>(entries.size()));
+    put16(end, static_cast<uint16_t>(entries.size()));
+    put32(end, static_cast<uint32_t>(directory.size()));
+    put32(end, static_cast<uint32_t>(directoryOffset));
+    put16(end, 0);  // 注释长度
+    output(end.data(), end.size());
+    return good;
+}
+
+void XlsxWriter::beginCell(CellStyle style)
+{
+    xml += "<c r=\"";
+    appendColumnName(xml, column++);
+    xml += std::to_string(row);
+    xml += '"';
+    if (style != PlainCell) {
+        xml += " s=\"" + std::to_string(static_cast<int>(style)) + '"';
+    }
+}
+
+void XlsxWriter::flushXml(bool force)
+{
+    if (xml.size() >= BUFFER_SIZE || (force && !xml.empty())) {
+        writeEntryData(xml.data(), xml.size());
+        xml.clear();
+    }
+}
+
+void XlsxWriter::writeEntry(const std::string &name, const std::string &content)
+{
+    beginEntry(name);
+    writeEntryData(content.data(), content.size());
+    endEntry();
+}
+
+void XlsxWriter::beginEntry(const std::string &name)
+{
+    current = Entry();
+    current.name = name;
+    current.crc = static_cast<uint32_t>(crc32(0, Z_NULL, 0));
+    current.offset = static_cast<uint32_t>(offset);
+    deflateReset(zstream.get());
+
+    // 大小和 CRC 此时未知，填 0，写在数据之后的描述符中
+    std::string header;
+    put32(header, 0x04034b50);
+    put16(header, ZIP_VERSION);
+    put16(header, ZIP_FLAGS);
+    put16(header, Z_DEFLATED);
+    put16(header, DOS_TIME);
+    put16(header, DOS_DATE);
+    put32(header, 0);
+    put32(header, 0);
+    put32(header, 0);
+    put16(header, static_cast<uint16_t>(name.size()));
+    put16(header, 0);
+    header += name;
+    output(header.data(), header.size());
+}
+
+void XlsxWriter::writeEntryData(const char *data, size_t size)
+{
+    current.crc = static_cast<uint32_t>(crc32(current.crc, reinterpret_cast<const Bytef *>(data),
+                                              static_cast<uInt>(size)));
+    current.size += static_cast<uint32_t>(size);
+    deflateData(data, size, false);
+}
+
+void XlsxWriter::endEntry()
+{
+    deflateData(nullptr, 0, true);
+
+    std::string descriptor;
+    put32(descriptor, 0x08074b50);
+    put32(descriptor, current.crc);
+    put32(descriptor, current.compressedSize);
+    put32(descriptor, current.size);
+    output(descriptor.data(), descriptor.size());
+    entries.push_back(current);
+}
+
+void XlsxWriter::deflateData(const char *data, size_t size, bool last)
+{
+    if (!good) {
+        return;
+    }
+    z_stream_s &z = *zstream;
+    z.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    z.avail_in = static_cast<uInt>(size);
+    do {
+        z.next_out = reinterpret_cast<Bytef *>(deflateBuffer.data());
+        z.avail_out = static_cast<uInt>(deflateBuffer.size());
+        if (deflate(&z, last ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR) {
+            good = false;
+            return;
+        }
+        size_t produced = deflateBuffer.size() - z.avail_out;
+        current.compressedSize += static_cast<uint32_t>(produced);
+        output(deflateBuffer.data(), produced);
+    } while (z.avail_out == 0);
+}
+
+void XlsxWriter::output(const char *data, size_t size)
+{
+    if (!good || size == 0) {
+        return;
+    }
+    // 不写 zip64，超过 4 GB 时失败
+    if (offset + size > UINT32_MAX || !sink(data, size)) {
+        good = false;
+        return;
+    }
+    offset += size;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct z_stream_s;
+
+// 流式写出只有一个工作表的 .xlsx 文件。工作表 XML 边生成边经 deflate 压缩写出，
+// 内存中只有固定大小的缓冲区和共享字符串表，后者只随不同字符串的数量增长，与行数无关。
+// 不依赖 Qt；写出的字节交给 sink，sink 返回 false 表示写入失败，之后的操作都被忽略
+class XlsxWriter {
+public:
+    typedef std::function<bool(const char *data, size_t size)> Sink;
+
+    // 单元格样式，与 styles.xml 中 cellXfs 的顺序一致
+    enum CellStyle {
+        PlainCell = 0,
+        HeaderCell,     // 粗体
+        ClockCell,      // hh:mm:ss，数值为一天中的比例
+        DurationCell    // [mm]:ss，数值以天为单位，分钟不按小时折回
+    };
+
+    // columnWidths 为各列的宽度（字符数）
+    XlsxWriter(Sink sink, const std::string &sheetName, const std::vector<double> &columnWidths);
+    ~XlsxWriter();
+
+    XlsxWriter(const XlsxWriter &) = delete;
+    XlsxWriter &operator=(const XlsxWriter &) = delete;
+
+    // 按行依次添加单元格
+    void beginRow();
+    // 相同的字符串在共享字符串表中只保存一次
+    void addString(const std::string &utf8, CellStyle style = PlainCell);
+    void addNumber(double value, CellStyle style = PlainCell);
+    void endRow();
+
+    // 写出共享字符串表和 zip 目录，之后不能再添加行
+    bool finish();
+    bool ok() const { return good; }
+
+private:
+    struct Entry {
+        std::string name;
+        uint32_t crc;
+        uint32_t compressedSize;
+        uint32_t size;
+        uint32_t offset;  // 本地文件头的位置
+    };
+
+    void writeEntry(const std::string &name, const std::string &content);
+    void beginEntry(const std::string &name);
+    void writeEntryData(const char *data, size_t size);
+    void endEntry();
+    void deflateData(const char *data, size_t size, bool last);
+    void output(const char *data, size_t size);
+    void flushXml(bool force);
+    void beginCell(CellStyle style);
+
+    static const size_t BUFFER_SIZE = 64 * 1024;
+
+    Sink sink;
+    bool good;
+    bool finished;
+    uint64_t offset;  // 已写出的字节数
+    std::vector<Entry> entries;
+    Entry current;
+    std::unique_ptr<z_stream_s> zstream;
+    std::vector<char> deflateBuffer;
+
+    std::string xml;  // 等待压缩的 XML，超过 BUFFER_SIZE 时写出
+    uint32_t row;
+    uint32_t column;
+    std::ostringstream number;  // 按 C 区域设置格式化数值，不受系统小数点影响
+
+    std::unordered_map<std::string, uint32_t> sharedIndex;
+    std::vector<const std::string *> sharedStrings;  // 按序号排列，指向 sharedIndex 的键
+    uint32_t sharedRefs;
+};